@@ -1,7 +1,7 @@
 #include "ast.h"
 
-#include "scope_checker.h"
 #include "string_manager.h"
+#include "visitor.h"
 
 #include <sstream>
 
@@ -35,24 +35,26 @@ namespace ast
 
 	BaseExpr::BaseExpr(AstExprType ast_type, BodyExpr* body) : ast_type(ast_type), body(body) {}
 
-	AstExprType BaseExpr::get_type() const
+	void* BaseExpr::operator new(size_t size)
 	{
-		return this->ast_type;
+		return astArena::allocate(size, alignof(std::max_align_t));
 	}
 
+	void BaseExpr::operator delete(void* ptr) {}
+
 	BodyExpr* BaseExpr::get_body() const
 	{
 		return this->body;
 	}
 
-	void BaseExpr::set_line_info(const ExpressionLineInfo& line_info)
+	void BaseExpr::set_source_range(const sourceManager::SourceRange& source_range)
 	{
-		this->line_info = line_info;
+		this->source_range = source_range;
 	}
 
-	ExpressionLineInfo BaseExpr::get_line_info() const
+	const sourceManager::SourceRange& BaseExpr::get_source_range() const
 	{
-		return this->line_info;
+		return this->source_range;
 	}
 
 	void BaseExpr::set_mangled(bool mangled)
@@ -65,29 +67,17 @@ namespace ast
 		return this->is_name_mangled;
 	}
 
-	void BaseExpr::set_parent_data(BaseExpr* parent, int location)
-	{
-		this->parent.parent = parent;
-		this->parent.location = location;
-	}
-
-	parent_data BaseExpr::get_parent_data() const
-	{
-		return this->parent;
-	}
-
 	bool BaseExpr::is_constant() const
 	{
 		return this->constant_status == ConstantStatus::Constant ||
 			this->constant_status == ConstantStatus::CanBeConstant;
 	}
 
-	LiteralExpr::LiteralExpr(BodyExpr* body, const types::Type& curr_type, const std::string& str) :
+	LiteralExpr::LiteralExpr(BodyExpr* body, const types::Type& curr_type, const types::LiteralValue& value) :
 		BaseExpr(AstExprType::LiteralExpr, body),
-		curr_type(curr_type)
-	{
-		value_type = types::BaseType::create_type(curr_type, str);
-	}
+		curr_type(curr_type),
+		value(value)
+	{}
 
 	LiteralExpr::~LiteralExpr() {}
 
@@ -99,7 +89,7 @@ namespace ast
 
 		str << tabs << "Literal Value : {" << constant_to_string(this) << '\n';
 		str << tabs << '\t' << "Type: " << this->curr_type.to_string() << '\n';
-		str << tabs << '\t' << "Value: " << this->value_type->to_string() << '\n';
+		str << tabs << '\t' << "Value: " << types::literal_to_string(this->curr_type, this->value) << '\n';
 		str << tabs << "}," << '\n';
 
 		return str.str();
@@ -112,7 +102,7 @@ namespace ast
 		root.addData(ExprTypeKeyString, "Literal Value");
 		// TODO: Check if these shouls use toJson
 		root.addData("value_type", this->curr_type.to_string());
-		root.addData("value", this->value_type->to_string());
+		root.addData("value", types::literal_to_string(this->curr_type, this->value));
 
 		return root;
 	}
@@ -145,12 +135,7 @@ namespace ast
 		curr_type(curr_type),
 		name_id(name_id),
 		expr(std::move(expr))
-	{
-		if (this->expr != nullptr)
-		{
-			this->expr->set_parent_data(this, 0);
-		}
-	}
+	{}
 
 	VariableDeclarationExpr::~VariableDeclarationExpr() {}
 
@@ -246,11 +231,6 @@ namespace ast
 
 	types::Type VariableReferenceExpr::get_result_type()
 	{
-		if (result_type.get_type_enum() == types::TypeEnum::None)
-		{
-			// result_type = this->get_body()->named_types[this->name];
-			result_type = scope::get_scope(this)->named_types[this->name_id];
-		}
 		return result_type;
 	}
 
@@ -259,15 +239,18 @@ namespace ast
 		return true;
 	}
 
+	void VariableReferenceExpr::bind(int slot, const types::Type& type)
+	{
+		this->slot = slot;
+		this->result_type = type;
+	}
+
 	BinaryExpr::BinaryExpr(BodyExpr* body, operators::BinaryOp binop, ptr_type<BaseExpr> lhs, ptr_type<BaseExpr> rhs) :
 		BaseExpr(AstExprType::BinaryExpr, body),
 		binop(binop),
 		lhs(std::move(lhs)),
 		rhs(std::move(rhs))
-	{
-		this->lhs->set_parent_data(this, 0);
-		this->rhs->set_parent_data(this, 1);
-	}
+	{}
 
 	BinaryExpr::~BinaryExpr() {}
 
@@ -427,7 +410,6 @@ namespace ast
 
 	void BodyExpr::add_base(ptr_type<BaseExpr> expr)
 	{
-		expr->set_parent_data(this, expressions.size());
 		expressions.push_back(std::move(expr));
 	}
 
@@ -442,30 +424,12 @@ namespace ast
 		original_function_prototypes.push_back(proto);
 	}
 
-	llvm::Type* BodyExpr::get_llvm_type(llvm::LLVMContext& llvm_context, int str_id)
-	{
-		auto f = this->llvm_named_types.find(str_id);
-		if (f != this->llvm_named_types.end())
-		{
-			return f->second;
-		}
-		llvm::Type* type = types::get_llvm_type(llvm_context, this->named_types[str_id]);
-		this->llvm_named_types[str_id] = type;
-		return type;
-	}
-
-	CallExpr::CallExpr(BodyExpr* body, int callee_id, std::vector<ptr_type<BaseExpr>>& args) :
+	CallExpr::CallExpr(BodyExpr* body, int callee_id, NodeVector<ptr_type<BaseExpr>>& args) :
 		BaseExpr(AstExprType::CallExpr, body),
 		callee_id(callee_id),
 		unmangled_callee_id(callee_id),
-		args(args.size())
-	{
-		for (int i = 0; i < this->args.size(); i++)
-		{
-			this->args[i] = std::move(args[i]);
-			this->args[i]->set_parent_data(this, i);
-		}
-	}
+		args(std::move(args))
+	{}
 
 	CallExpr::~CallExpr() {}
 
@@ -509,32 +473,16 @@ namespace ast
 	{
 		if (result_type.get_type_enum() == types::TypeEnum::None)
 		{
-			// result_type = scope::get_scope(ptr_type<CallExpr>(this))->function_prototypes[this->callee]->return_type;
-			result_type = scope::get_scope(this)->function_prototypes[this->callee_id]->return_type;
-			// result_type = this->get_body()->function_prototypes[this->callee]->return_type;
+			result_type = prototype->return_type;
 		}
 		return result_type;
 	}
 
 	bool CallExpr::check_types()
 	{
-		/*
-		FunctionPrototype* proto = this->get_body()->function_prototypes[this->callee];
-		if (proto == nullptr)
-		{
-			proto = this->get_body()->get_body()->function_prototypes[this->callee];
-		}
-
-		BodyExpr* b1 = this->get_body();
-		BodyExpr* b2 = this->get_body()->get_body();
-		*/
-		// ptr_type<FunctionPrototype> proto =
-		// scope::get_scope(ptr_type<CallExpr>(this))->function_prototypes[this->callee];
-		FunctionPrototype* proto = scope::get_scope(this)->function_prototypes[this->callee_id];
-
 		for (int i = 0; i < this->args.size(); i++)
 		{
-			if (this->args[i]->get_result_type() != proto->types[i])
+			if (this->args[i]->get_result_type() != prototype->types[i])
 			{
 				return false;
 			}
@@ -554,14 +502,7 @@ namespace ast
 		if_body(std::move(if_body)),
 		else_body(std::move(else_body)),
 		should_return_value(should_return_value)
-	{
-		this->condition->set_parent_data(this, 0);
-		this->if_body->set_parent_data(this, 1);
-		if (this->else_body != nullptr)
-		{
-			this->else_body->set_parent_data(this, 2);
-		}
-	}
+	{}
 
 	std::string IfExpr::to_string(int depth) const
 	{
@@ -661,15 +602,7 @@ namespace ast
 		end_expr(std::move(end_expr)),
 		step_expr(std::move(step_expr)),
 		for_body(std::move(for_body))
-	{
-		this->start_expr->set_parent_data(this, 0);
-		this->end_expr->set_parent_data(this, 1);
-		if (this->step_expr != nullptr)
-		{
-			this->step_expr->set_parent_data(this, 2);
-		}
-		this->for_body->set_parent_data(this, 3);
-	}
+	{}
 
 	std::string ForExpr::to_string(int depth) const
 	{
@@ -758,10 +691,7 @@ namespace ast
 		BaseExpr(AstExprType::WhileExpr, body),
 		end_expr(std::move(end_expr)),
 		while_body(std::move(while_body))
-	{
-		this->end_expr->set_parent_data(this, 0);
-		this->while_body->set_parent_data(this, 1);
-	}
+	{}
 
 	std::string WhileExpr::to_string(int depth) const
 	{
@@ -1016,9 +946,7 @@ namespace ast
 		BaseExpr(ast::AstExprType::UnaryExpr, body),
 		unop(unop),
 		expr(std::move(expr))
-	{
-		this->expr->set_parent_data(this, 0);
-	}
+	{}
 
 	std::string UnaryExpr::to_string(int depth) const
 	{
@@ -1108,16 +1036,11 @@ namespace ast
 		return true;
 	}
 
-	SwitchExpr::SwitchExpr(BodyExpr* body, ptr_type<BaseExpr> value_expr, std::vector<ptr_type<CaseExpr>>& cases) :
+	SwitchExpr::SwitchExpr(BodyExpr* body, ptr_type<BaseExpr> value_expr, NodeVector<ptr_type<CaseExpr>>& cases) :
 		BaseExpr(AstExprType::SwitchExpr, body),
-		value_expr(std::move(value_expr))
-	{
-		for (auto& case_expr : cases)
-		{
-			case_expr->set_parent_data(this, this->cases.size());
-			this->cases.push_back(std::move(case_expr));
-		}
-	}
+		value_expr(std::move(value_expr)),
+		cases(std::move(cases))
+	{}
 
 	std::string SwitchExpr::to_string(int depth) const
 	{
@@ -1173,9 +1096,9 @@ namespace ast
 
 	CaseExpr::CaseExpr(BodyExpr* body, ptr_type<BaseExpr> case_expr, ptr_type<BaseExpr> case_body, bool default_case) :
 		BaseExpr(AstExprType::CaseExpr, body),
+		default_case(default_case),
 		case_expr(std::move(case_expr)),
-		case_body(std::move(case_body)),
-		default_case(default_case)
+		case_body(std::move(case_body))
 	{}
 
 	std::string CaseExpr::to_string(int depth) const
@@ -1259,6 +1182,13 @@ namespace ast
 		args(args)
 	{}
 
+	void* FunctionPrototype::operator new(size_t size)
+	{
+		return astArena::allocate(size, alignof(FunctionPrototype));
+	}
+
+	void FunctionPrototype::operator delete(void* ptr) {}
+
 	std::string FunctionPrototype::to_string(int depth) const
 	{
 		std::string tabs(depth, '\t');
@@ -1312,6 +1242,13 @@ namespace ast
 
 	FunctionDefinition::~FunctionDefinition() {}
 
+	void* FunctionDefinition::operator new(size_t size)
+	{
+		return astArena::allocate(size, alignof(FunctionDefinition));
+	}
+
+	void FunctionDefinition::operator delete(void* ptr) {}
+
 	std::string FunctionDefinition::to_string(int depth) const
 	{
 		std::string tabs(depth, '\t');
@@ -1359,4 +1296,118 @@ namespace ast
 
 		return false;
 	}
+	static void add_to_parent_table(ParentTable& table, BaseExpr* expr, BaseExpr* parent, int location)
+	{
+		if (expr == nullptr)
+		{
+			return;
+		}
+
+		table[expr] = parent_data{parent, location};
+
+		ast::visit(
+			expr,
+			[&table](auto* e)
+			{
+				using T = std::remove_pointer_t<decltype(e)>;
+
+				if constexpr (std::is_same_v<T, BodyExpr>)
+				{
+					for (auto& f : e->functions)
+					{
+						add_to_parent_table(table, f->body.get(), nullptr, 0);
+					}
+					for (int i = 0; i < e->expressions.size(); i++)
+					{
+						add_to_parent_table(table, e->expressions[i].get(), e, i);
+					}
+				}
+				else if constexpr (
+					std::is_same_v<T, VariableDeclarationExpr> || std::is_same_v<T, UnaryExpr> ||
+					std::is_same_v<T, CastExpr>)
+				{
+					add_to_parent_table(table, e->expr.get(), e, 0);
+				}
+				else if constexpr (std::is_same_v<T, BinaryExpr>)
+				{
+					add_to_parent_table(table, e->lhs.get(), e, 0);
+					add_to_parent_table(table, e->rhs.get(), e, 1);
+				}
+				else if constexpr (std::is_same_v<T, CallExpr>)
+				{
+					for (int i = 0; i < e->args.size(); i++)
+					{
+						add_to_parent_table(table, e->args[i].get(), e, i);
+					}
+				}
+				else if constexpr (std::is_same_v<T, IfExpr>)
+				{
+					add_to_parent_table(table, e->condition.get(), e, 0);
+					add_to_parent_table(table, e->if_body.get(), e, 1);
+					add_to_parent_table(table, e->else_body.get(), e, 2);
+				}
+				else if constexpr (std::is_same_v<T, ForExpr>)
+				{
+					add_to_parent_table(table, e->start_expr.get(), e, 0);
+					add_to_parent_table(table, e->end_expr.get(), e, 1);
+					add_to_parent_table(table, e->step_expr.get(), e, 2);
+					add_to_parent_table(table, e->for_body.get(), e, 3);
+				}
+				else if constexpr (std::is_same_v<T, WhileExpr>)
+				{
+					add_to_parent_table(table, e->end_expr.get(), e, 0);
+					add_to_parent_table(table, e->while_body.get(), e, 1);
+				}
+				else if constexpr (std::is_same_v<T, ReturnExpr>)
+				{
+					add_to_parent_table(table, e->ret_expr.get(), e, 0);
+				}
+				else if constexpr (std::is_same_v<T, SwitchExpr>)
+				{
+					add_to_parent_table(table, e->value_expr.get(), e, -1);
+					for (int i = 0; i < e->cases.size(); i++)
+					{
+						add_to_parent_table(table, e->cases[i].get(), e, i);
+					}
+				}
+				else if constexpr (std::is_same_v<T, CaseExpr>)
+				{
+					add_to_parent_table(table, e->case_expr.get(), e, 0);
+					add_to_parent_table(table, e->case_body.get(), e, 1);
+				}
+			});
+	}
+
+	ParentTable build_parent_table(BodyExpr* body)
+	{
+		ParentTable table;
+		add_to_parent_table(table, body, nullptr, 0);
+		return table;
+	}
+
+	// The size of every node, so any growth is caught when building, the asts for generated code can have tens of
+	// millions of nodes, so the node sizes are the peak memory use. The sizes are for 64 bit linux with libstdc++.
+#if defined(__x86_64__) && defined(__GLIBCXX__)
+	static_assert(sizeof(types::Type) == 4);
+	static_assert(sizeof(BaseExpr) == 40);
+	static_assert(sizeof(LiteralExpr) == 48);
+	static_assert(sizeof(BodyExpr) == 176);
+	static_assert(sizeof(VariableDeclarationExpr) == 56);
+	static_assert(sizeof(VariableReferenceExpr) == 48);
+	static_assert(sizeof(BinaryExpr) == 56);
+	static_assert(sizeof(CallExpr) == 80);
+	static_assert(sizeof(IfExpr) == 64);
+	static_assert(sizeof(ForExpr) == 80);
+	static_assert(sizeof(WhileExpr) == 56);
+	static_assert(sizeof(CommentExpr) == 40);
+	static_assert(sizeof(ReturnExpr) == 48);
+	static_assert(sizeof(ContinueExpr) == 40);
+	static_assert(sizeof(BreakExpr) == 40);
+	static_assert(sizeof(UnaryExpr) == 48);
+	static_assert(sizeof(CastExpr) == 56);
+	static_assert(sizeof(SwitchExpr) == 72);
+	static_assert(sizeof(CaseExpr) == 56);
+	static_assert(sizeof(FunctionPrototype) == 72);
+	static_assert(sizeof(FunctionDefinition) == 24);
+#endif
 }
@@ -3,18 +3,19 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
-#include "llvm/IR/Instructions.h"
-
 #include "../config.h"
 #include "../json.h"
+#include "ast_arena.h"
 #include "operators.h"
+#include "source_manager.h"
 #include "types.h"
 
 namespace ast
 {
-	enum class AstExprType
+	enum class AstExprType : uint8_t
 	{
 		BaseExpr,
 		LiteralExpr,
@@ -36,23 +37,8 @@ namespace ast
 		CaseExpr,
 	};
 
-	struct ExpressionLineInfo
-	{
-		int start_line = 0;
-		int end_line = 0;
-		int start_pos = 0;
-		int end_pos = 0;
-		std::string line;
-	};
-
-	enum class ReferenceType
-	{
-		Variable,
-		Function,
-	};
-
 	// Values must be defind with most constant at 0 & least constant at INT_MAX
-	enum class ConstantStatus : int
+	enum class ConstantStatus : uint8_t
 	{
 		Unknown,
 		Constant,
@@ -96,21 +82,9 @@ namespace ast
 	class FunctionPrototype;
 	class FunctionDefinition;
 
-	struct parent_data
-	{
-		ast::BaseExpr* parent = nullptr;
-		// location stores information about where the child is located within the parent object
-		//     BodyExpr: location is index of the expressions
-		//     VariableDeclarationExpr: location is 0 for expression
-		//     BinaryExpr: location is 0 for lhs, and 1 for rhs
-		//     CallExpr: location is index of the arguments
-		//     IfExpr: location is 0 for condition, 1 for if body, and 2 for else body
-		//     ForExpr: location is 0 for start,  1 for end, 2 for step, and 3 for body
-		//     WhileExpr: location is 0 for end, and 1 for body
-		//     UnaryExpr: location is 0 for expresion
-		//     SwitchExpr: location is index of the case expression
-		int location = 0;
-	};
+	// the vectors of child nodes are stored in the ast arena with the nodes
+	template<class T>
+	using NodeVector = std::vector<T, astArena::Allocator<T>>;
 
 	// The expr ast class
 	class BaseExpr
@@ -118,48 +92,54 @@ namespace ast
 	public:
 		BaseExpr(AstExprType ast_type, BodyExpr* body);
 		virtual ~BaseExpr() = default;
+		// the nodes are allocated in the ast arena, and only freed when the arena is released
+		static void* operator new(size_t size);
+		static void operator delete(void* ptr);
 		virtual std::string to_string(int depth) const = 0;
 		virtual json::JsonValue to_json() const = 0;
 		virtual types::Type get_result_type() = 0;
 		virtual bool check_types() = 0;
 
-		virtual AstExprType get_type() const final;
-		virtual BodyExpr* get_body() const final;
-		virtual void set_line_info(const ExpressionLineInfo& line_info) final;
-		virtual ExpressionLineInfo get_line_info() const final;
-		virtual void set_mangled(bool mangled) final;
-		virtual bool is_mangled() const final;
-		virtual void set_parent_data(BaseExpr* parent, int location) final;
-		virtual parent_data get_parent_data() const final;
-		virtual bool is_constant() const final;
-
+		// inline, as every tree walk dispatches on it
+		AstExprType get_type() const
+		{
+			return this->ast_type;
+		}
+		BodyExpr* get_body() const;
+		void set_source_range(const sourceManager::SourceRange& source_range);
+		const sourceManager::SourceRange& get_source_range() const;
+		void set_mangled(bool mangled);
+		bool is_mangled() const;
+		bool is_constant() const;
+
+		// the small members are declared together, so they share the padding after the vtable pointer
 		ConstantStatus constant_status = ConstantStatus::Unknown;
 
 	protected:
 		AstExprType ast_type = AstExprType::BaseExpr;
-		BodyExpr* body;
-		types::Type result_type{types::TypeEnum::None};
-		ExpressionLineInfo line_info;
 		bool is_name_mangled = false;
-		parent_data parent;
+		types::Type result_type{types::TypeEnum::None};
+		BodyExpr* body;
+		sourceManager::SourceRange source_range;
 	};
 
 	// Any literal value
 	class LiteralExpr : public BaseExpr
 	{
 	public:
-		LiteralExpr(BodyExpr* body, const types::Type& curr_type, const std::string& str);
+		LiteralExpr(BodyExpr* body, const types::Type& curr_type, const types::LiteralValue& value);
 		~LiteralExpr() override;
 		std::string to_string(int depth) const override;
 		json::JsonValue to_json() const override;
 		types::Type get_result_type() override;
 		bool check_types() override;
 
+		// the value is stored inline, curr_type says which member of it is used
 		types::Type curr_type;
-		ptr_type<types::BaseType> value_type;
+		types::LiteralValue value;
 	};
 
-	enum class BodyType
+	enum class BodyType : uint8_t
 	{
 		Global,
 		Function,
@@ -183,24 +163,16 @@ namespace ast
 		void add_base(ptr_type<BaseExpr> expr);
 		void add_function(ptr_type<FunctionDefinition> func);
 		void add_prototype(FunctionPrototype* proto);
-		// TODO: remove?
-		llvm::Type* get_llvm_type(llvm::LLVMContext& llvm_context, int str_id);
 
 		// bool is_function_body = false;
 		FunctionPrototype* parent_function = nullptr;
 		BodyType body_type;
-		std::vector<std::pair<int, ReferenceType>>
-			in_scope_vars; // only used for checking vars are in scope, and order of defines
-		std::vector<ptr_type<BaseExpr>> expressions;
+		NodeVector<ptr_type<BaseExpr>> expressions;
 		// TODO: redo this mess
-		std::vector<ptr_type<FunctionDefinition>> functions;
-		std::vector<FunctionPrototype*> original_function_prototypes;
+		NodeVector<ptr_type<FunctionDefinition>> functions;
+		NodeVector<FunctionPrototype*> original_function_prototypes;
 		std::map<int, FunctionPrototype*> function_prototypes;
 		// std::map<std::string, FunctionDefinition*> functions;
-		std::map<int, types::Type> named_types;
-		std::map<int, llvm::Type*> llvm_named_types;
-		std::map<int, llvm::AllocaInst*> llvm_named_values;
-		std::vector<int> extern_functions;
 	};
 
 	// Any variable declaration
@@ -216,6 +188,8 @@ namespace ast
 
 		types::Type curr_type;
 		int name_id;
+		// the index of the variable within its function, set by the type checker
+		int slot = -1;
 		ptr_type<BaseExpr> expr;
 	};
 
@@ -228,8 +202,11 @@ namespace ast
 		json::JsonValue to_json() const override;
 		types::Type get_result_type() override;
 		bool check_types() override;
+		// binds the reference to the variable it refers to, called by the type checker
+		void bind(int slot, const types::Type& type);
 
 		int name_id;
+		int slot = -1;
 	};
 
 	// Any binary expression
@@ -251,7 +228,7 @@ namespace ast
 	class CallExpr : public BaseExpr
 	{
 	public:
-		CallExpr(BodyExpr* body, int callee_id, std::vector<ptr_type<BaseExpr>>& args);
+		CallExpr(BodyExpr* body, int callee_id, NodeVector<ptr_type<BaseExpr>>& args);
 		~CallExpr() override;
 		std::string to_string(int depth) const override;
 		json::JsonValue to_json() const override;
@@ -260,8 +237,10 @@ namespace ast
 
 		int callee_id;
 		int unmangled_callee_id;
-		std::vector<ptr_type<BaseExpr>> args;
 		bool is_extern = false;
+		// the prototype of the function being called, set by the type checker
+		FunctionPrototype* prototype = nullptr;
+		NodeVector<ptr_type<BaseExpr>> args;
 	};
 
 	class IfExpr : public BaseExpr
@@ -302,6 +281,7 @@ namespace ast
 
 		types::Type var_type;
 		int name_id;
+		int slot = -1;
 		ptr_type<BaseExpr> start_expr;
 		ptr_type<BaseExpr> end_expr;
 		ptr_type<BaseExpr> step_expr;
@@ -393,7 +373,7 @@ namespace ast
 	class SwitchExpr : public BaseExpr
 	{
 	public:
-		SwitchExpr(BodyExpr* body, ptr_type<BaseExpr> value_expr, std::vector<ptr_type<CaseExpr>>& cases);
+		SwitchExpr(BodyExpr* body, ptr_type<BaseExpr> value_expr, NodeVector<ptr_type<CaseExpr>>& cases);
 		std::string to_string(int depth) const override;
 		json::JsonValue to_json() const override;
 		types::Type get_result_type() override;
@@ -401,7 +381,7 @@ namespace ast
 
 		bool should_return_value = false; // should the switch return a value after being evaluated
 		ptr_type<BaseExpr> value_expr;
-		std::vector<ptr_type<CaseExpr>> cases;
+		NodeVector<ptr_type<CaseExpr>> cases;
 	};
 
 	class CaseExpr : public BaseExpr
@@ -414,9 +394,9 @@ namespace ast
 		bool check_types() override;
 
 		// bool should_return_value = false; // should the switch return a value after being evaluated
+		bool default_case = false;
 		ptr_type<BaseExpr> case_expr;
 		ptr_type<BaseExpr> case_body;
-		bool default_case = false;
 	};
 
 	// The prototype for a function (i.e. the definition)
@@ -431,6 +411,8 @@ namespace ast
 		std::string to_string(int depth) const;
 		json::JsonValue to_json() const;
 		FunctionPrototype(const FunctionPrototype&) = delete;
+		static void* operator new(size_t size);
+		static void operator delete(void* ptr);
 
 		int name_id;
 		int unmangled_name_id;
@@ -446,11 +428,40 @@ namespace ast
 	public:
 		FunctionDefinition(FunctionPrototype* prototype, ptr_type<BodyExpr> body);
 		~FunctionDefinition();
+		static void* operator new(size_t size);
+		static void operator delete(void* ptr);
 		std::string to_string(int depth) const;
 		json::JsonValue to_json() const;
 		bool check_return_type() const;
 
 		FunctionPrototype* prototype;
 		ptr_type<BodyExpr> body;
+		// the number of variable slots used by the function, including the arguments
+		int slot_count = 0;
 	};
+
+	struct parent_data
+	{
+		ast::BaseExpr* parent = nullptr;
+		// location stores information about where the child is located within the parent object
+		//     BodyExpr: location is index of the expressions
+		//     VariableDeclarationExpr: location is 0 for expression
+		//     BinaryExpr: location is 0 for lhs, and 1 for rhs
+		//     CallExpr: location is index of the arguments
+		//     IfExpr: location is 0 for condition, 1 for if body, and 2 for else body
+		//     ForExpr: location is 0 for start,  1 for end, 2 for step, and 3 for body
+		//     WhileExpr: location is 0 for end, and 1 for body
+		//     ReturnExpr: location is 0 for the return value
+		//     UnaryExpr: location is 0 for expresion
+		//     CastExpr: location is 0 for expresion
+		//     SwitchExpr: location is index of the case expression, and -1 for the value
+		//     CaseExpr: location is 0 for the case value, and 1 for the body
+		int location = 0;
+	};
+
+	// The parent of every node in a tree, it is rarely needed, so it is built on demand instead of being stored
+	// in every node. The bodies of functions are included, but have no parent.
+	using ParentTable = std::unordered_map<const BaseExpr*, parent_data>;
+
+	ParentTable build_parent_table(BodyExpr* body);
 }
@@ -0,0 +1,105 @@
+#include "ast_arena.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace astArena
+{
+	static constexpr size_t BlockSize = 256 * 1024;
+
+	class ArenaState
+	{
+	public:
+		std::mutex mutex;
+		std::vector<std::unique_ptr<char[]>> blocks;
+		size_t allocated_bytes = 0;
+		// bumped by release, so each thread knows its current block has been freed
+		std::atomic<uint64_t> generation{0};
+	};
+
+	class ThreadBlock
+	{
+	public:
+		char* ptr = nullptr;
+		char* end = nullptr;
+		uint64_t generation = 0;
+	};
+
+	static thread_local ThreadBlock thread_block;
+
+	ArenaState& get_state();
+	char* allocate_block(size_t size);
+}
+
+astArena::ArenaState& astArena::get_state()
+{
+	// never destroyed, so nodes that are destroyed during static destruction can't outlive the arena
+	static ArenaState& state = *new ArenaState;
+	return state;
+}
+
+char* astArena::allocate_block(size_t size)
+{
+	ArenaState& state = get_state();
+	std::lock_guard<std::mutex> lock{state.mutex};
+
+	state.blocks.push_back(std::make_unique<char[]>(size));
+	state.allocated_bytes += size;
+	return state.blocks.back().get();
+}
+
+void* astArena::allocate(size_t size, size_t alignment)
+{
+	assert((alignment & (alignment - 1)) == 0 && "alignment must be a power of 2");
+
+	uint64_t generation = get_state().generation.load(std::memory_order_relaxed);
+	if (thread_block.generation != generation)
+	{
+		thread_block = ThreadBlock{nullptr, nullptr, generation};
+	}
+
+	uintptr_t ptr = reinterpret_cast<uintptr_t>(thread_block.ptr);
+	uintptr_t aligned_ptr = (ptr + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+
+	if (thread_block.ptr == nullptr || aligned_ptr + size > reinterpret_cast<uintptr_t>(thread_block.end))
+	{
+		// large allocations get their own block, so they don't waste the rest of the current one
+		if (size + alignment > BlockSize / 4)
+		{
+			char* block = allocate_block(size + alignment);
+			uintptr_t block_ptr = reinterpret_cast<uintptr_t>(block);
+			return reinterpret_cast<void*>((block_ptr + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1));
+		}
+
+		char* block = allocate_block(BlockSize);
+		thread_block.ptr = block;
+		thread_block.end = block + BlockSize;
+
+		ptr = reinterpret_cast<uintptr_t>(thread_block.ptr);
+		aligned_ptr = (ptr + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+	}
+
+	thread_block.ptr = reinterpret_cast<char*>(aligned_ptr + size);
+	return reinterpret_cast<void*>(aligned_ptr);
+}
+
+void astArena::release()
+{
+	ArenaState& state = get_state();
+	std::lock_guard<std::mutex> lock{state.mutex};
+
+	state.blocks.clear();
+	state.allocated_bytes = 0;
+	state.generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+size_t astArena::get_allocated_bytes()
+{
+	ArenaState& state = get_state();
+	std::lock_guard<std::mutex> lock{state.mutex};
+	return state.allocated_bytes;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+// A bump allocator that holds all of the ast nodes, function prototypes and child node vectors.
+// Memory is never given back one allocation at a time, the blocks are only freed by release,
+// so freeing a whole ast is a handful of block frees. Each thread bumps through its own block.
+namespace astArena
+{
+	void* allocate(size_t size, size_t alignment);
+	// frees every block, all of the nodes must have already been destroyed
+	void release();
+	size_t get_allocated_bytes();
+
+	// An allocator for std containers that are owned by ast nodes
+	template<class T>
+	class Allocator
+	{
+	public:
+		using value_type = T;
+		using is_always_equal = std::true_type;
+
+		Allocator() noexcept = default;
+		template<class U>
+		Allocator(const Allocator<U>&) noexcept
+		{}
+
+		T* allocate(size_t count)
+		{
+			return static_cast<T*>(astArena::allocate(count * sizeof(T), alignof(T)));
+		}
+
+		void deallocate(T*, size_t) noexcept {}
+
+		template<class U>
+		bool operator==(const Allocator<U>&) const noexcept
+		{
+			return true;
+		}
+
+		template<class U>
+		bool operator!=(const Allocator<U>&) const noexcept
+		{
+			return false;
+		}
+	};
+}
@@ -1,18 +1,21 @@
 #include <iostream>
+#include <memory>
 #include <optional>
 
 #include "llvm/ADT/APInt.h"
 #include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/DiagnosticPrinter.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/MC/SubtargetFeature.h"
 #include "llvm/MC/TargetRegistry.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/TargetSelect.h"
 
 #include "builder.h"
 #include "module_manager.h"
-#include "scope_checker.h"
 #include "string_manager.h"
+#include "visitor.h"
 
 using std::dynamic_pointer_cast;
 
@@ -40,12 +43,14 @@ namespace builder
 		llvm_context = new llvm::LLVMContext();
 		llvm_module = new llvm::Module("ash-boot", *llvm_context);
 		llvm_ir_builder = new llvm::IRBuilder<>(*llvm_context);
+		llvm_types = new types::LlvmTypeTable(*llvm_context);
 
 		// llvm_context->setDiagnosticHandlerCallBack(&this->diagnostic_handler_callback);
 	}
 
 	LLVMBuilder::~LLVMBuilder()
 	{
+		delete llvm_types;
 		delete llvm_ir_builder;
 		delete llvm_module;
 		delete llvm_context;
@@ -56,10 +61,10 @@ namespace builder
 		}
 	}
 
-	bool LLVMBuilder::set_target()
+	bool LLVMBuilder::set_target(const TargetConfig& target_config)
 	{
 		// setup targets
-		std::string target_triple = llvm::sys::getDefaultTargetTriple();
+		target_triple = llvm::sys::getDefaultTargetTriple();
 
 		llvm::InitializeAllTargetInfos();
 		llvm::InitializeAllTargets();
@@ -68,7 +73,7 @@ namespace builder
 		llvm::InitializeAllAsmPrinters();
 
 		std::string error;
-		const llvm::Target* target = llvm::TargetRegistry::lookupTarget(target_triple, error);
+		target = llvm::TargetRegistry::lookupTarget(target_triple, error);
 
 		if (!target)
 		{
@@ -76,20 +81,83 @@ namespace builder
 			return false;
 		}
 
-		const char* cpu = "generic";
-		const char* features = "";
+		llvm::SubtargetFeatures features;
 
-		llvm::TargetOptions opt;
-		std::optional<llvm::Reloc::Model> rec = std::optional<llvm::Reloc::Model>();
+		if (target_config.cpu == "native")
+		{
+			target_cpu = llvm::sys::getHostCPUName().str();
+
+			// the host cpu name doesn't say which optional features are enabled, so they are queried separately
+			llvm::StringMap<bool> host_features;
+			if (llvm::sys::getHostCPUFeatures(host_features))
+			{
+				for (auto& feature : host_features)
+				{
+					features.AddFeature(feature.first(), feature.second);
+				}
+			}
+		}
+		else
+		{
+			target_cpu = target_config.cpu;
+		}
 
-		target_machine = target->createTargetMachine(target_triple, cpu, features, opt, rec);
+		// the given features are added last, so they override the host features
+		llvm::SubtargetFeatures extra_features(target_config.features);
+		for (auto& feature : extra_features.getFeatures())
+		{
+			features.AddFeature(feature);
+		}
+		target_features = features.getString();
+
+		// checked before making the target machine, which would warn and then fall back to the generic cpu
+		std::unique_ptr<llvm::MCSubtargetInfo> subtarget_info{target->createMCSubtargetInfo(target_triple, "", "")};
+		if (!subtarget_info->isCPUStringValid(target_cpu))
+		{
+			std::cout << "Unknown target cpu: " << target_cpu << std::endl;
+			return false;
+		}
+
+		this->reloc_model = target_config.reloc_model;
+		this->code_model = target_config.code_model;
+
+		target_machine = create_target_machine().release();
 
 		llvm_module->setDataLayout(target_machine->createDataLayout());
 		llvm_module->setTargetTriple(target_triple);
 
+		if (target_config.reloc_model == llvm::Reloc::PIC_)
+		{
+			llvm_module->setPICLevel(llvm::PICLevel::BigPIC);
+		}
+		if (target_config.code_model.has_value())
+		{
+			llvm_module->setCodeModel(*target_config.code_model);
+		}
+
 		return true;
 	}
 
+	std::unique_ptr<llvm::TargetMachine> LLVMBuilder::create_target_machine() const
+	{
+		llvm::TargetOptions opt;
+
+		std::unique_ptr<llvm::TargetMachine> new_target_machine{target->createTargetMachine(
+			target_triple,
+			target_cpu,
+			target_features,
+			opt,
+			reloc_model,
+			code_model)};
+
+		if (target_machine != nullptr)
+		{
+			new_target_machine->setOptLevel(target_machine->getOptLevel());
+		}
+
+		return new_target_machine;
+	}
+
 	llvm::Value* LLVMBuilder::log_error_value(const std::string& str)
 	{
 		std::cout << str << std::endl;
@@ -108,12 +176,12 @@ namespace builder
 		std::vector<llvm::Type*> types;
 		for (auto& type : prototype->types)
 		{
-			types.push_back(types::get_llvm_type(*llvm_context, type));
+			types.push_back(llvm_types->get_llvm_type(type));
 		}
 
 		// create the function type
 		llvm::FunctionType* ft =
-			llvm::FunctionType::get(types::get_llvm_type(*llvm_context, prototype->return_type), types, false);
+			llvm::FunctionType::get(llvm_types->get_llvm_type(prototype->return_type), types, false);
 
 		std::string proto_name;
 
@@ -134,6 +202,16 @@ namespace builder
 
 		llvm::Function* f = llvm::Function::Create(ft, llvm::Function::ExternalLinkage, proto_name, llvm_module);
 
+		// the passes and codegen read the cpu from the function, so it has to match the target machine
+		if (target_cpu != "generic")
+		{
+			f->addFnAttr("target-cpu", target_cpu);
+		}
+		if (!target_features.empty())
+		{
+			f->addFnAttr("target-features", target_features);
+		}
+
 		// set names for all arguments
 
 		int index = 0;
@@ -189,20 +267,17 @@ namespace builder
 		llvm::BasicBlock* bb = llvm::BasicBlock::Create(*llvm_context, "entry", the_function);
 		llvm_ir_builder->SetInsertPoint(bb);
 
-		// record the functions types and arguments
-		// llvm_named_types.clear();
-		// llvm_named_values.clear();
+		// the nested functions have all been generated, so the slots only hold this functions variables
+		slot_allocas.assign(function_definition->slot_count, nullptr);
 
+		// the arguments are in the first slots
 		for (auto& arg : the_function->args())
 		{
 			llvm::AllocaInst* alloca = create_entry_block_alloca(the_function, arg.getType(), arg.getName());
 
 			llvm_ir_builder->CreateStore(&arg, alloca);
 
-			// llvm_named_values[std::string{ arg.getName() }] = alloca;
-			std::string name{ arg.getName() };
-			function_definition->body->llvm_named_values[stringManager::get_id(name)] = alloca;
-			function_definition->body->llvm_named_types[stringManager::get_id(name)] = arg.getType();
+			slot_allocas[arg.getArgNo()] = alloca;
 		}
 
 		llvm::Value* return_value = generate_code_dispatch(function_definition->body.get());
@@ -232,7 +307,7 @@ namespace builder
 			// validate the generated code, checking for consistency
 			llvm::verifyFunction(*the_function);
 
-			// Todo: run the optimiser on the function
+			// the optimiser runs on the whole module once every function has been generated
 
 			return the_function;
 		}
@@ -247,7 +322,7 @@ namespace builder
 	template<>
 	llvm::Value* LLVMBuilder::generate_code<ast::LiteralExpr>(ast::LiteralExpr* expr)
 	{
-		return expr->value_type->get_value(llvm_context);
+		return types::get_literal_constant(*llvm_context, expr->curr_type, expr->value);
 	}
 
 	template<>
@@ -282,7 +357,6 @@ namespace builder
 		llvm::Function* the_function = llvm_ir_builder->GetInsertBlock()->getParent();
 
 		// register the variable and emit its initialiser
-		const int var_id = expr->name_id;
 		ast::BaseExpr* init = expr->expr.get();
 
 		// Emit the initializer before adding the variable to scope, this prevents
@@ -306,22 +380,17 @@ namespace builder
 		else
 		{
 			// use defualt value
-			init_value = types::get_default_value(*llvm_context, expr->curr_type);
+			init_value = llvm_types->get_default_value(expr->curr_type);
 		}
 
 		llvm::AllocaInst* alloca = create_entry_block_alloca(
 			the_function,
-			types::get_llvm_type(*llvm_context, expr->curr_type),
+			llvm_types->get_llvm_type(expr->curr_type),
 			stringManager::get_string(expr->name_id));
 		llvm_ir_builder->CreateStore(init_value, alloca);
 
-		// remember the old varibale binding so we can restore when the function ends
-		// old_binding = llvm_named_values[var_name];
 		// remember the new binding
-		// llvm_named_values[var_name] = alloca;
-		// llvm_named_types[var_name] = types::get_llvm_type(*llvm_context, expr->curr_type);
-		expr->get_body()->llvm_named_values[var_id] = alloca;
-		expr->get_body()->llvm_named_types[var_id] = types::get_llvm_type(*llvm_context, expr->curr_type);
+		slot_allocas[expr->slot] = alloca;
 
 		// create the body code?????????
 		// TODO: SORT
@@ -340,25 +409,17 @@ namespace builder
 	llvm::Value* LLVMBuilder::generate_code<ast::VariableReferenceExpr>(ast::VariableReferenceExpr* expr)
 	{
 		// lookup the variable in the function
-		// auto f = llvm_named_values.find(expr->name);
-		// auto f = expr->get_body()->llvm_named_values.find(expr->name);
-		auto b = scope::get_scope(expr);
-		// if (f == expr->get_body()->llvm_named_values.end())
-		if (b == nullptr)
+		llvm::AllocaInst* alloca = slot_allocas[expr->slot];
+		if (alloca == nullptr)
 		{
-			return log_error_value("unknown variable name: " + stringManager::get_string(expr->name_id));
+			return log_error_value("unknown variable name: " + std::string{stringManager::get_string(expr->name_id)});
 		}
 
-		auto f = b->llvm_named_values.find(expr->name_id);
-
 		// load the value
-		// return llvm_ir_builder->CreateLoad(llvm_named_types[f->first], f->second, f->first.c_str());
-		// return llvm_ir_builder->CreateLoad(expr->get_body()->llvm_named_types[f->first], f->second,
-		// f->first.c_str()); std::string name = ;
 		return llvm_ir_builder->CreateLoad(
-			b->get_llvm_type(*llvm_context, f->first),
-			f->second,
-			stringManager::get_string(f->first));
+			alloca->getAllocatedType(),
+			alloca,
+			stringManager::get_string(expr->name_id));
 	}
 
 	template<>
@@ -368,7 +429,7 @@ namespace builder
 		if (expr->binop == operators::BinaryOp::Assignment)
 		{
 			// lhs must be a variable definition or declaration
-			ast::VariableReferenceExpr* lhs_expr = dynamic_cast<ast::VariableReferenceExpr*>(expr->lhs.get());
+			ast::VariableReferenceExpr* lhs_expr = ast::dyn_expr_cast<ast::VariableReferenceExpr>(expr->lhs.get());
 			if (lhs_expr == nullptr)
 			{
 				return log_error_value("destination of '=' must be an identifier");
@@ -382,17 +443,15 @@ namespace builder
 				return nullptr;
 			}
 
-			// look up the name
-			// auto f = llvm_named_values.find(lhs_expr->name);
-			// auto f = lhs_expr->get_body()->llvm_named_values.find(lhs_expr->name_id);
-			ast::BodyExpr* scope = scope::get_scope(lhs_expr);
-			auto f = scope->llvm_named_values.find(lhs_expr->name_id);
-			if (f == scope->llvm_named_values.end())
+			// look up the variable
+			llvm::AllocaInst* alloca = slot_allocas[lhs_expr->slot];
+			if (alloca == nullptr)
 			{
-				return log_error_value("unknown variable name: " + stringManager::get_string(lhs_expr->name_id));
+				return log_error_value(
+					"unknown variable name: " + std::string{stringManager::get_string(lhs_expr->name_id)});
 			}
 
-			llvm_ir_builder->CreateStore(rhs, f->second);
+			llvm_ir_builder->CreateStore(rhs, alloca);
 			return rhs;
 		}
 
@@ -903,12 +962,12 @@ namespace builder
 				llvm_ir_builder->SetInsertPoint(end_block);
 
 				llvm::PHINode* phi_node = llvm_ir_builder->CreatePHI(
-					types::get_llvm_type(*llvm_context, expr->get_result_type()),
+					llvm_types->get_llvm_type(expr->get_result_type()),
 					2,
 					"and.res");
 
 				phi_node->addIncoming(
-					types::get_default_value(*llvm_context, types::Type{ types::TypeEnum::Bool }),
+					llvm_types->get_default_value(types::Type{ types::TypeEnum::Bool }),
 					lhs_end_block);
 				phi_node->addIncoming(rhs, rhs_end_block);
 				return phi_node;
@@ -992,13 +1051,13 @@ namespace builder
 				llvm_ir_builder->SetInsertPoint(end_block);
 
 				llvm::PHINode* phi_node = llvm_ir_builder->CreatePHI(
-					types::get_llvm_type(*llvm_context, expr->get_result_type()),
+					llvm_types->get_llvm_type(expr->get_result_type()),
 					2,
 					"or.res");
 
 				phi_node->addIncoming(
 					llvm::ConstantInt::get(
-						types::get_llvm_type(*llvm_context, types::Type{ types::TypeEnum::Bool }),
+						llvm_types->get_llvm_type(types::Type{ types::TypeEnum::Bool }),
 						1,
 						false),
 					lhs_end_block);
@@ -1252,7 +1311,7 @@ namespace builder
 		if (expr->should_return_value)
 		{
 			llvm::PHINode* phi_node =
-				llvm_ir_builder->CreatePHI(types::get_llvm_type(*llvm_context, expr->get_result_type()), 2, "ifres");
+				llvm_ir_builder->CreatePHI(llvm_types->get_llvm_type(expr->get_result_type()), 2, "ifres");
 
 			phi_node->addIncoming(if_value, if_block);
 			phi_node->addIncoming(else_value, else_block);
@@ -1272,7 +1331,7 @@ namespace builder
 		// create an alloc in the start block
 		llvm::AllocaInst* alloca = create_entry_block_alloca(
 			func,
-			types::get_llvm_type(*llvm_context, expr->var_type),
+			llvm_types->get_llvm_type(expr->var_type),
 			stringManager::get_string(expr->name_id));
 
 		// emit the start code
@@ -1287,7 +1346,7 @@ namespace builder
 		// store the value
 		llvm_ir_builder->CreateStore(start_value, alloca);
 
-		expr->for_body->llvm_named_values[expr->name_id] = alloca;
+		slot_allocas[expr->slot] = alloca;
 
 		// create the condition block
 		llvm::BasicBlock* condition_block = llvm::BasicBlock::Create(*llvm_context, "for.cond", func);
@@ -1584,7 +1643,7 @@ namespace builder
 			return expr_value;
 		}
 
-		llvm::Type* llvm_target_type = types::get_llvm_type(*llvm_context, target_type);
+		llvm::Type* llvm_target_type = llvm_types->get_llvm_type(target_type);
 
 		llvm::Constant* constant_value = nullptr;
 
@@ -1671,7 +1730,7 @@ namespace builder
 						return llvm_ir_builder->CreateICmpNE(
 							expr_value,
 							llvm::ConstantInt::get(
-								types::get_llvm_type(*llvm_context, types::Type{ from_type.get_type_enum() }),
+								llvm_types->get_llvm_type(types::Type{ from_type.get_type_enum() }),
 								0,
 								from_type.is_signed()),
 							"convert_to_bool");
@@ -1783,6 +1842,7 @@ namespace builder
 			static_cast<unsigned int>(expr->cases.size()));
 
 		std::vector<llvm::BasicBlock*> case_blocks;
+		case_blocks.reserve(expr->cases.size());
 
 		for (auto& case_expr : expr->cases)
 		{
@@ -1797,19 +1857,10 @@ namespace builder
 			}
 			else
 			{
-				llvm::Value* value = generate_code_dispatch(case_expr->case_expr.get());
-				if (value == nullptr)
-				{
-					null_end;
-					return nullptr;
-				}
-
-				case_value = llvm::dyn_cast<llvm::ConstantInt>(value);
-				if (case_value == nullptr)
-				{
-					null_end;
-					return nullptr;
-				}
+				// the type checker has made sure each case value is an integer literal
+				const ast::LiteralExpr* literal_expr = ast::expr_cast<ast::LiteralExpr>(case_expr->case_expr.get());
+				case_value = llvm::cast<llvm::ConstantInt>(
+					types::get_literal_constant(*llvm_context, literal_expr->curr_type, literal_expr->value));
 			}
 
 			if (case_expr->default_case)
@@ -1836,10 +1887,10 @@ namespace builder
 			}
 
 			// skip adding of default br instruction, if last expression in case body is a break
-			ast::BodyExpr* body = dynamic_cast<ast::BodyExpr*>(expr->cases[i]->case_body.get());
+			ast::BodyExpr* body = ast::dyn_expr_cast<ast::BodyExpr>(expr->cases[i]->case_body.get());
 			if (body != nullptr && body->expressions.size() > 0)
 			{
-				ast::BreakExpr* break_expr = dynamic_cast<ast::BreakExpr*>(body->expressions.back().get());
+				ast::BreakExpr* break_expr = ast::dyn_expr_cast<ast::BreakExpr>(body->expressions.back().get());
 				if (break_expr != nullptr)
 				{
 					continue;
@@ -1883,80 +1934,7 @@ namespace builder
 
 	llvm::Value* LLVMBuilder::generate_code_dispatch(ast::BaseExpr* expr)
 	{
-		switch (expr->get_type())
-		{
-			case ast::AstExprType::LiteralExpr:
-			{
-				return generate_code(dynamic_cast<ast::LiteralExpr*>(expr));
-			}
-			case ast::AstExprType::BodyExpr:
-			{
-				return generate_code(dynamic_cast<ast::BodyExpr*>(expr));
-			}
-			case ast::AstExprType::VariableDeclarationExpr:
-			{
-				return generate_code(dynamic_cast<ast::VariableDeclarationExpr*>(expr));
-			}
-			case ast::AstExprType::VariableReferenceExpr:
-			{
-				return generate_code(dynamic_cast<ast::VariableReferenceExpr*>(expr));
-			}
-			case ast::AstExprType::BinaryExpr:
-			{
-				return generate_code(dynamic_cast<ast::BinaryExpr*>(expr));
-			}
-			case ast::AstExprType::CallExpr:
-			{
-				return generate_code(dynamic_cast<ast::CallExpr*>(expr));
-			}
-			case ast::AstExprType::IfExpr:
-			{
-				return generate_code(dynamic_cast<ast::IfExpr*>(expr));
-			}
-			case ast::AstExprType::ForExpr:
-			{
-				return generate_code(dynamic_cast<ast::ForExpr*>(expr));
-			}
-			case ast::AstExprType::WhileExpr:
-			{
-				return generate_code(dynamic_cast<ast::WhileExpr*>(expr));
-			}
-			case ast::AstExprType::CommentExpr:
-			{
-				return generate_code(dynamic_cast<ast::CommentExpr*>(expr));
-			}
-			case ast::AstExprType::ReturnExpr:
-			{
-				return generate_code(dynamic_cast<ast::ReturnExpr*>(expr));
-			}
-			case ast::AstExprType::ContinueExpr:
-			{
-				return generate_code(dynamic_cast<ast::ContinueExpr*>(expr));
-			}
-			case ast::AstExprType::BreakExpr:
-			{
-				return generate_code(dynamic_cast<ast::BreakExpr*>(expr));
-			}
-			case ast::AstExprType::UnaryExpr:
-			{
-				return generate_code(dynamic_cast<ast::UnaryExpr*>(expr));
-			}
-			case ast::AstExprType::CastExpr:
-			{
-				return generate_code(dynamic_cast<ast::CastExpr*>(expr));
-			}
-			case ast::AstExprType::SwitchExpr:
-			{
-				return generate_code(dynamic_cast<ast::SwitchExpr*>(expr));
-			}
-			case ast::AstExprType::CaseExpr:
-			{
-				return generate_code(dynamic_cast<ast::CaseExpr*>(expr));
-			}
-		}
-		assert(false && "Missing Type Specialisation");
-		null_end;
-		return nullptr;
+		return ast::visit(expr, [this](auto* e) { return generate_code(e); });
 	}
 
 	void LLVMBuilder::diagnostic_handler_callback(const llvm::DiagnosticInfo& di, void* context)
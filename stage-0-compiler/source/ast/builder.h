@@ -1,6 +1,9 @@
 #pragma once
 
 #include <map>
+#include <memory>
+#include <optional>
+#include <string>
 #include <type_traits>
 
 #include "llvm/IR/IRBuilder.h"
@@ -11,13 +14,27 @@
 
 namespace builder
 {
+	// the target the code is built for, the defaults give code that runs on any cpu of the host's architecture
+	class TargetConfig
+	{
+	public:
+		// a cpu name, or native for the host cpu and its features
+		std::string cpu = "generic";
+		// a comma separated list of features, e.g. +avx2,-bmi
+		std::string features;
+		std::optional<llvm::Reloc::Model> reloc_model;
+		std::optional<llvm::CodeModel::Model> code_model;
+	};
+
 	class LLVMBuilder
 	{
 	public:
 		LLVMBuilder();
 		~LLVMBuilder();
 
-		bool set_target();
+		bool set_target(const TargetConfig& target_config);
+		// makes another target machine for the target that was set, with the same codegen level
+		std::unique_ptr<llvm::TargetMachine> create_target_machine() const;
 		llvm::Function* generate_function_definition(ast::FunctionDefinition* function);
 		llvm::Function* generate_function_prototype(ast::FunctionPrototype* prototype);
 		llvm::Value* log_error_value(const std::string& str);
@@ -38,7 +55,18 @@ namespace builder
 		llvm::TargetMachine* target_machine = nullptr;
 
 	private:
+		// the llvm types are looked up by type id, instead of being made again for every use
+		types::LlvmTypeTable* llvm_types;
 		std::vector<llvm::BasicBlock*> continue_blocks;
 		std::vector<llvm::BasicBlock*> break_blocks;
+		// the variables of the function being generated, indexed by slot
+		std::vector<llvm::AllocaInst*> slot_allocas;
+		const llvm::Target* target = nullptr;
+		std::string target_triple;
+		std::optional<llvm::Reloc::Model> reloc_model;
+		std::optional<llvm::CodeModel::Model> code_model;
+		// the resolved cpu and features, which are also added to each function
+		std::string target_cpu;
+		std::string target_features;
 	};
 }
@@ -1,5 +1,7 @@
 #include "constant_checker.h"
 
+#include "visitor.h"
+
 namespace constant_checker
 {
 	using ast::ConstantStatus;
@@ -288,77 +290,6 @@ namespace constant_checker
 
 	void check_expression_dispatch(ast::BaseExpr* expr)
 	{
-		switch (expr->get_type())
-		{
-			case ast::AstExprType::LiteralExpr:
-			{
-				return check_expression(dynamic_cast<ast::LiteralExpr*>(expr));
-			}
-			case ast::AstExprType::BodyExpr:
-			{
-				return check_expression(dynamic_cast<ast::BodyExpr*>(expr));
-			}
-			case ast::AstExprType::VariableDeclarationExpr:
-			{
-				return check_expression(dynamic_cast<ast::VariableDeclarationExpr*>(expr));
-			}
-			case ast::AstExprType::VariableReferenceExpr:
-			{
-				return check_expression(dynamic_cast<ast::VariableReferenceExpr*>(expr));
-			}
-			case ast::AstExprType::BinaryExpr:
-			{
-				return check_expression(dynamic_cast<ast::BinaryExpr*>(expr));
-			}
-			case ast::AstExprType::CallExpr:
-			{
-				return check_expression(dynamic_cast<ast::CallExpr*>(expr));
-			}
-			case ast::AstExprType::IfExpr:
-			{
-				return check_expression(dynamic_cast<ast::IfExpr*>(expr));
-			}
-			case ast::AstExprType::ForExpr:
-			{
-				return check_expression(dynamic_cast<ast::ForExpr*>(expr));
-			}
-			case ast::AstExprType::WhileExpr:
-			{
-				return check_expression(dynamic_cast<ast::WhileExpr*>(expr));
-			}
-			case ast::AstExprType::CommentExpr:
-			{
-				return check_expression(dynamic_cast<ast::CommentExpr*>(expr));
-			}
-			case ast::AstExprType::ReturnExpr:
-			{
-				return check_expression(dynamic_cast<ast::ReturnExpr*>(expr));
-			}
-			case ast::AstExprType::ContinueExpr:
-			{
-				return check_expression(dynamic_cast<ast::ContinueExpr*>(expr));
-			}
-			case ast::AstExprType::BreakExpr:
-			{
-				return check_expression(dynamic_cast<ast::BreakExpr*>(expr));
-			}
-			case ast::AstExprType::UnaryExpr:
-			{
-				return check_expression(dynamic_cast<ast::UnaryExpr*>(expr));
-			}
-			case ast::AstExprType::CastExpr:
-			{
-				return check_expression(dynamic_cast<ast::CastExpr*>(expr));
-			}
-			case ast::AstExprType::SwitchExpr:
-			{
-				return check_expression(dynamic_cast<ast::SwitchExpr*>(expr));
-			}
-			case ast::AstExprType::CaseExpr:
-			{
-				return check_expression(dynamic_cast<ast::CaseExpr*>(expr));
-			}
-		}
-		assert(false && "Missing Type Specialisation");
+		ast::visit(expr, [](auto* e) { check_expression(e); });
 	}
 }
@@ -0,0 +1,1038 @@
+#include "constant_folder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+#include "visitor.h"
+
+namespace constant_folder
+{
+	// the low width bits of the value
+	static uint64_t truncate(uint64_t value, int width)
+	{
+		if (width >= 64)
+		{
+			return value;
+		}
+		return value & ((1ull << width) - 1);
+	}
+
+	// the width bits of the value as a signed integer
+	static int64_t sign_extend(uint64_t value, int width)
+	{
+		if (width >= 64)
+		{
+			return static_cast<int64_t>(value);
+		}
+		uint64_t sign_bit = 1ull << (width - 1);
+		return static_cast<int64_t>((truncate(value, width) ^ sign_bit) - sign_bit);
+	}
+
+	// the bits of an int, char or bool literal, zero extended from the width of its type
+	static uint64_t get_bits(const ast::LiteralExpr* literal)
+	{
+		switch (literal->curr_type.get_type_enum())
+		{
+			case types::TypeEnum::Bool:
+			{
+				return literal->value.bool_value ? 1 : 0;
+			}
+			case types::TypeEnum::Char:
+			{
+				return static_cast<uint8_t>(literal->value.char_value);
+			}
+			default:
+			{
+				return truncate(literal->value.int_value, literal->curr_type.get_size());
+			}
+		}
+	}
+
+	// the value of an int, char or bool literal, extended to 64 bits using the sign of its type
+	static uint64_t get_extended_bits(const ast::LiteralExpr* literal)
+	{
+		uint64_t bits = get_bits(literal);
+		if (literal->curr_type.is_signed())
+		{
+			return static_cast<uint64_t>(sign_extend(bits, literal->curr_type.get_size()));
+		}
+		return bits;
+	}
+
+	// f32 literals are rounded to a float, as that is what the builder makes
+	static double get_float(const ast::LiteralExpr* literal)
+	{
+		if (literal->curr_type.get_size() == 32)
+		{
+			return static_cast<float>(literal->value.float_value);
+		}
+		return literal->value.float_value;
+	}
+
+	static ptr_type<ast::BaseExpr> make_literal(
+		const ast::BaseExpr* replaced_expr,
+		const types::Type& type,
+		const types::LiteralValue& value)
+	{
+		ptr_type<ast::LiteralExpr> literal = make_ptr<ast::LiteralExpr>(replaced_expr->get_body(), type, value);
+		literal->set_source_range(replaced_expr->get_source_range());
+		literal->constant_status = ast::ConstantStatus::Constant;
+		literal->check_types();
+		return literal;
+	}
+
+	// makes a literal of an int, char or bool type, the bits are truncated to the width of the type
+	static ptr_type<ast::BaseExpr> make_int_literal(
+		const ast::BaseExpr* replaced_expr,
+		const types::Type& type,
+		uint64_t bits)
+	{
+		types::LiteralValue value{0};
+
+		switch (type.get_type_enum())
+		{
+			case types::TypeEnum::Bool:
+			{
+				value.bool_value = (bits & 1) != 0;
+				break;
+			}
+			case types::TypeEnum::Char:
+			{
+				value.char_value = static_cast<char>(bits & 0xFF);
+				break;
+			}
+			default:
+			{
+				// signed values are kept sign extended, so they print as negative numbers
+				if (type.is_signed())
+				{
+					value.int_value = static_cast<uint64_t>(sign_extend(bits, type.get_size()));
+				}
+				else
+				{
+					value.int_value = truncate(bits, type.get_size());
+				}
+				break;
+			}
+		}
+
+		return make_literal(replaced_expr, type, value);
+	}
+
+	static ptr_type<ast::BaseExpr> make_float_literal(
+		const ast::BaseExpr* replaced_expr,
+		const types::Type& type,
+		double float_value)
+	{
+		types::LiteralValue value{0};
+
+		if (type.get_size() == 32)
+		{
+			value.float_value = static_cast<float>(float_value);
+		}
+		else
+		{
+			value.float_value = float_value;
+		}
+
+		return make_literal(replaced_expr, type, value);
+	}
+
+	static ptr_type<ast::BaseExpr> make_bool_literal(const ast::BaseExpr* replaced_expr, bool bool_value)
+	{
+		return make_int_literal(replaced_expr, types::Type{types::TypeEnum::Bool}, bool_value ? 1 : 0);
+	}
+
+	// does the expr contain a return, break or continue, these end the block they are built into,
+	// so code containing them is only moved out of an if or switch by the builder
+	static bool contains_jump(ast::BaseExpr* expr)
+	{
+		if (expr == nullptr)
+		{
+			return false;
+		}
+
+		return ast::visit(
+			expr,
+			[](auto* e) -> bool
+			{
+				using T = std::remove_pointer_t<decltype(e)>;
+
+				if constexpr (
+					std::is_same_v<T, ast::ReturnExpr> || std::is_same_v<T, ast::BreakExpr> ||
+					std::is_same_v<T, ast::ContinueExpr>)
+				{
+					return true;
+				}
+				else if constexpr (std::is_same_v<T, ast::BodyExpr>)
+				{
+					return std::any_of(
+						e->expressions.begin(),
+						e->expressions.end(),
+						[](const ptr_type<ast::BaseExpr>& child) { return contains_jump(child.get()); });
+				}
+				else if constexpr (std::is_same_v<T, ast::VariableDeclarationExpr>)
+				{
+					return contains_jump(e->expr.get());
+				}
+				else if constexpr (std::is_same_v<T, ast::BinaryExpr>)
+				{
+					return contains_jump(e->lhs.get()) || contains_jump(e->rhs.get());
+				}
+				else if constexpr (std::is_same_v<T, ast::CallExpr>)
+				{
+					return std::any_of(
+						e->args.begin(),
+						e->args.end(),
+						[](const ptr_type<ast::BaseExpr>& child) { return contains_jump(child.get()); });
+				}
+				else if constexpr (std::is_same_v<T, ast::IfExpr>)
+				{
+					return contains_jump(e->condition.get()) || contains_jump(e->if_body.get()) ||
+						contains_jump(e->else_body.get());
+				}
+				else if constexpr (std::is_same_v<T, ast::ForExpr>)
+				{
+					return contains_jump(e->start_expr.get()) || contains_jump(e->end_expr.get()) ||
+						contains_jump(e->step_expr.get()) || contains_jump(e->for_body.get());
+				}
+				else if constexpr (std::is_same_v<T, ast::WhileExpr>)
+				{
+					return contains_jump(e->end_expr.get()) || contains_jump(e->while_body.get());
+				}
+				else if constexpr (std::is_same_v<T, ast::UnaryExpr> || std::is_same_v<T, ast::CastExpr>)
+				{
+					return contains_jump(e->expr.get());
+				}
+				else if constexpr (std::is_same_v<T, ast::SwitchExpr>)
+				{
+					return contains_jump(e->value_expr.get()) ||
+						std::any_of(
+							e->cases.begin(),
+							e->cases.end(),
+							[](const ptr_type<ast::CaseExpr>& child) { return contains_jump(child.get()); });
+				}
+				else if constexpr (std::is_same_v<T, ast::CaseExpr>)
+				{
+					return contains_jump(e->case_body.get());
+				}
+				else
+				{
+					return false;
+				}
+			});
+	}
+
+	// folds an int binary expr, returns false if the result is undefined, e.g. a divide by zero
+	static bool fold_int_binary(
+		operators::BinaryOp binop,
+		const types::Type& type,
+		uint64_t lhs,
+		uint64_t rhs,
+		uint64_t& result)
+	{
+		const int width = type.get_size();
+		const bool is_signed = type.is_signed();
+
+		switch (binop)
+		{
+			case operators::BinaryOp::Addition:
+			{
+				result = lhs + rhs;
+				return true;
+			}
+			case operators::BinaryOp::Subtraction:
+			{
+				result = lhs - rhs;
+				return true;
+			}
+			case operators::BinaryOp::Multiplication:
+			{
+				result = lhs * rhs;
+				return true;
+			}
+			case operators::BinaryOp::Division:
+			case operators::BinaryOp::Modulo:
+			{
+				if (truncate(rhs, width) == 0)
+				{
+					return false;
+				}
+
+				if (is_signed)
+				{
+					int64_t signed_lhs = sign_extend(lhs, width);
+					int64_t signed_rhs = sign_extend(rhs, width);
+
+					// the smallest value divided by -1 overflows
+					if (signed_rhs == -1 && signed_lhs == sign_extend(1ull << (width - 1), width))
+					{
+						return false;
+					}
+
+					result = static_cast<uint64_t>(
+						binop == operators::BinaryOp::Division ? signed_lhs / signed_rhs : signed_lhs % signed_rhs);
+				}
+				else
+				{
+					uint64_t unsigned_lhs = truncate(lhs, width);
+					uint64_t unsigned_rhs = truncate(rhs, width);
+
+					result = binop == operators::BinaryOp::Division ? unsigned_lhs / unsigned_rhs
+																	: unsigned_lhs % unsigned_rhs;
+				}
+				return true;
+			}
+			case operators::BinaryOp::BitwiseAnd:
+			{
+				result = lhs & rhs;
+				return true;
+			}
+			case operators::BinaryOp::BitwiseOr:
+			{
+				result = lhs | rhs;
+				return true;
+			}
+			case operators::BinaryOp::BitwiseXor:
+			{
+				result = lhs ^ rhs;
+				return true;
+			}
+			case operators::BinaryOp::BitwiseShiftLeft:
+			case operators::BinaryOp::BitwiseShiftRight:
+			{
+				// shifting by the width or more is undefined
+				if (rhs >= static_cast<uint64_t>(width))
+				{
+					return false;
+				}
+
+				if (binop == operators::BinaryOp::BitwiseShiftLeft)
+				{
+					result = lhs << rhs;
+				}
+				else if (is_signed)
+				{
+					result = static_cast<uint64_t>(sign_extend(lhs, width) >> rhs);
+				}
+				else
+				{
+					result = truncate(lhs, width) >> rhs;
+				}
+				return true;
+			}
+			default:
+			{
+				return false;
+			}
+		}
+	}
+
+	static bool fold_float_binary(
+		operators::BinaryOp binop,
+		const types::Type& type,
+		double lhs,
+		double rhs,
+		double& result)
+	{
+		// f32 maths is done as floats, so each step is rounded the same as at runtime
+		if (type.get_size() == 32)
+		{
+			float float_lhs = static_cast<float>(lhs);
+			float float_rhs = static_cast<float>(rhs);
+
+			switch (binop)
+			{
+				case operators::BinaryOp::Addition:
+				{
+					result = float_lhs + float_rhs;
+					return true;
+				}
+				case operators::BinaryOp::Subtraction:
+				{
+					result = float_lhs - float_rhs;
+					return true;
+				}
+				case operators::BinaryOp::Multiplication:
+				{
+					result = float_lhs * float_rhs;
+					return true;
+				}
+				case operators::BinaryOp::Division:
+				{
+					result = float_lhs / float_rhs;
+					return true;
+				}
+				case operators::BinaryOp::Modulo:
+				{
+					result = std::fmod(float_lhs, float_rhs);
+					return true;
+				}
+				default:
+				{
+					return false;
+				}
+			}
+		}
+
+		switch (binop)
+		{
+			case operators::BinaryOp::Addition:
+			{
+				result = lhs + rhs;
+				return true;
+			}
+			case operators::BinaryOp::Subtraction:
+			{
+				result = lhs - rhs;
+				return true;
+			}
+			case operators::BinaryOp::Multiplication:
+			{
+				result = lhs * rhs;
+				return true;
+			}
+			case operators::BinaryOp::Division:
+			{
+				result = lhs / rhs;
+				return true;
+			}
+			case operators::BinaryOp::Modulo:
+			{
+				result = std::fmod(lhs, rhs);
+				return true;
+			}
+			default:
+			{
+				return false;
+			}
+		}
+	}
+
+	// compares using the ordered float compares, so any compare with a nan is false
+	template<class T>
+	static bool fold_compare(operators::BinaryOp binop, T lhs, T rhs, bool& result)
+	{
+		switch (binop)
+		{
+			case operators::BinaryOp::LessThan:
+			{
+				result = lhs < rhs;
+				return true;
+			}
+			case operators::BinaryOp::LessThanEqual:
+			{
+				result = lhs <= rhs;
+				return true;
+			}
+			case operators::BinaryOp::GreaterThan:
+			{
+				result = lhs > rhs;
+				return true;
+			}
+			case operators::BinaryOp::GreaterThanEqual:
+			{
+				result = lhs >= rhs;
+				return true;
+			}
+			case operators::BinaryOp::EqualTo:
+			{
+				result = lhs == rhs;
+				return true;
+			}
+			case operators::BinaryOp::NotEqualTo:
+			{
+				result = lhs < rhs || lhs > rhs;
+				return true;
+			}
+			default:
+			{
+				return false;
+			}
+		}
+	}
+
+	// does the case body end with a break, which stops it falling through into the next case
+	static bool ends_in_break(ast::BaseExpr* case_body)
+	{
+		ast::BodyExpr* body = ast::dyn_expr_cast<ast::BodyExpr>(case_body);
+		return body != nullptr && body->expressions.size() > 0 &&
+			body->expressions.back()->get_type() == ast::AstExprType::BreakExpr;
+	}
+
+	template<>
+	ptr_type<ast::BaseExpr> fold_expression<ast::LiteralExpr>(ast::LiteralExpr* expr)
+	{
+		return nullptr;
+	}
+
+	template<>
+	ptr_type<ast::BaseExpr> fold_expression<ast::BodyExpr>(ast::BodyExpr* expr)
+	{
+		for (auto& f : expr->functions)
+		{
+			fold_body(f->body.get());
+		}
+
+		bool removed_expression = false;
+
+		for (auto& e : expr->expressions)
+		{
+			bool is_branch =
+				e->get_type() == ast::AstExprType::IfExpr || e->get_type() == ast::AstExprType::SwitchExpr;
+
+			fold_expression_dispatch(e);
+
+			// an if or switch where none of the code runs is left as an empty body, which can be removed
+			if (is_branch && e->get_type() == ast::AstExprType::BodyExpr &&
+				ast::expr_cast<ast::BodyExpr>(e.get())->expressions.empty())
+			{
+				e.reset();
+				removed_expression = true;
+			}
+		}
+
+		if (removed_expression)
+		{
+			expr->expressions.erase(
+				std::remove(expr->expressions.begin(), expr->expressions.end(), nullptr),
+				expr->expressions.end());
+		}
+
+		return nullptr;
+	}
+
+	template<>
+	ptr_type<ast::BaseExpr> fold_expression<ast::VariableDeclarationExpr>(ast::VariableDeclarationExpr* expr)
+	{
+		if (expr->expr != nullptr)
+		{
+			fold_expression_dispatch(expr->expr);
+		}
+		return nullptr;
+	}
+
+	template<>
+	ptr_type<ast::BaseExpr> fold_expression<ast::VariableReferenceExpr>(ast::VariableReferenceExpr* expr)
+	{
+		return nullptr;
+	}
+
+	template<>
+	ptr_type<ast::BaseExpr> fold_expression<ast::BinaryExpr>(ast::BinaryExpr* expr)
+	{
+		fold_expression_dispatch(expr->lhs);
+		fold_expression_dispatch(expr->rhs);
+
+		const ast::LiteralExpr* lhs = ast::dyn_expr_cast<ast::LiteralExpr>(expr->lhs.get());
+		const ast::LiteralExpr* rhs = ast::dyn_expr_cast<ast::LiteralExpr>(expr->rhs.get());
+
+		// a constant lhs decides if the rhs is used
+		if ((expr->binop == operators::BinaryOp::BooleanAnd || expr->binop == operators::BinaryOp::BooleanOr) &&
+			lhs != nullptr)
+		{
+			bool lhs_value = lhs->value.bool_value;
+
+			if (expr->binop == operators::BinaryOp::BooleanAnd && !lhs_value)
+			{
+				return make_bool_literal(expr, false);
+			}
+			if (expr->binop == operators::BinaryOp::BooleanOr && lhs_value)
+			{
+				return make_bool_literal(expr, true);
+			}
+			return std::move(expr->rhs);
+		}
+
+		if (lhs == nullptr || rhs == nullptr)
+		{
+			return nullptr;
+		}
+
+		const types::Type& operand_type = lhs->curr_type;
+		types::Type result_type = expr->get_result_type();
+
+		// only the types that the builder supports for each operator are folded
+		switch (expr->binop)
+		{
+			case operators::BinaryOp::Addition:
+			case operators::BinaryOp::Subtraction:
+			case operators::BinaryOp::Multiplication:
+			case operators::BinaryOp::Division:
+			case operators::BinaryOp::Modulo:
+			{
+				if (result_type.get_type_enum() == types::TypeEnum::Int)
+				{
+					uint64_t result = 0;
+					if (fold_int_binary(expr->binop, result_type, get_bits(lhs), get_bits(rhs), result))
+					{
+						return make_int_literal(expr, result_type, result);
+					}
+				}
+				else if (result_type.get_type_enum() == types::TypeEnum::Float)
+				{
+					// a nan result is left for runtime, as the bits of the nan depend on the target
+					double result = 0;
+					if (fold_float_binary(expr->binop, result_type, get_float(lhs), get_float(rhs), result) &&
+						!std::isnan(result))
+					{
+						return make_float_literal(expr, result_type, result);
+					}
+				}
+				return nullptr;
+			}
+			case operators::BinaryOp::BitwiseAnd:
+			case operators::BinaryOp::BitwiseOr:
+			case operators::BinaryOp::BitwiseXor:
+			case operators::BinaryOp::BitwiseShiftLeft:
+			case operators::BinaryOp::BitwiseShiftRight:
+			{
+				if (operand_type.get_type_enum() == types::TypeEnum::Int)
+				{
+					uint64_t result = 0;
+					if (fold_int_binary(expr->binop, operand_type, get_bits(lhs), get_bits(rhs), result))
+					{
+						return make_int_literal(expr, result_type, result);
+					}
+				}
+				return nullptr;
+			}
+			case operators::BinaryOp::LessThan:
+			case operators::BinaryOp::LessThanEqual:
+			case operators::BinaryOp::GreaterThan:
+			case operators::BinaryOp::GreaterThanEqual:
+			case operators::BinaryOp::EqualTo:
+			case operators::BinaryOp::NotEqualTo:
+			{
+				bool is_equality =
+					expr->binop == operators::BinaryOp::EqualTo || expr->binop == operators::BinaryOp::NotEqualTo;
+				bool result = false;
+
+				switch (operand_type.get_type_enum())
+				{
+					case types::TypeEnum::Bool:
+					{
+						if (!is_equality)
+						{
+							return nullptr;
+						}
+						[[fallthrough]];
+					}
+					case types::TypeEnum::Int:
+					case types::TypeEnum::Char:
+					{
+						if (operand_type.is_signed())
+						{
+							fold_compare(
+								expr->binop,
+								static_cast<int64_t>(get_extended_bits(lhs)),
+								static_cast<int64_t>(get_extended_bits(rhs)),
+								result);
+						}
+						else
+						{
+							fold_compare(expr->binop, get_bits(lhs), get_bits(rhs), result);
+						}
+						return make_bool_literal(expr, result);
+					}
+					case types::TypeEnum::Float:
+					{
+						fold_compare(expr->binop, get_float(lhs), get_float(rhs), result);
+						return make_bool_literal(expr, result);
+					}
+					default:
+					{
+						return nullptr;
+					}
+				}
+			}
+			default:
+			{
+				return nullptr;
+			}
+		}
+	}
+
+	template<>
+	ptr_type<ast::BaseExpr> fold_expression<ast::CallExpr>(ast::CallExpr* expr)
+	{
+		for (auto& e : expr->args)
+		{
+			fold_expression_dispatch(e);
+		}
+		return nullptr;
+	}
+
+	template<>
+	ptr_type<ast::BaseExpr> fold_expression<ast::IfExpr>(ast::IfExpr* expr)
+	{
+		fold_expression_dispatch(expr->condition);
+		fold_expression_dispatch(expr->if_body);
+		if (expr->else_body != nullptr)
+		{
+			fold_expression_dispatch(expr->else_body);
+		}
+
+		const ast::LiteralExpr* condition = ast::dyn_expr_cast<ast::LiteralExpr>(expr->condition.get());
+		if (condition == nullptr)
+		{
+			return nullptr;
+		}
+
+		ptr_type<ast::BaseExpr>& taken_body = condition->value.bool_value ? expr->if_body : expr->else_body;
+
+		if (taken_body == nullptr)
+		{
+			// none of the code runs
+			return make_ptr<ast::BodyExpr>(expr->get_body(), ast::BodyType::ScopeBlock);
+		}
+
+		if (contains_jump(taken_body.get()))
+		{
+			return nullptr;
+		}
+
+		// the body gives the same value as the if
+		return std::move(taken_body);
+	}
+
+	template<>
+	ptr_type<ast::BaseExpr> fold_expression<ast::ForExpr>(ast::ForExpr* expr)
+	{
+		fold_expression_dispatch(expr->start_expr);
+		fold_expression_dispatch(expr->end_expr);
+		if (expr->step_expr != nullptr)
+		{
+			fold_expression_dispatch(expr->step_expr);
+		}
+		fold_body(expr->for_body.get());
+		return nullptr;
+	}
+
+	template<>
+	ptr_type<ast::BaseExpr> fold_expression<ast::WhileExpr>(ast::WhileExpr* expr)
+	{
+		fold_expression_dispatch(expr->end_expr);
+		fold_expression_dispatch(expr->while_body);
+		return nullptr;
+	}
+
+	template<>
+	ptr_type<ast::BaseExpr> fold_expression<ast::CommentExpr>(ast::CommentExpr* expr)
+	{
+		return nullptr;
+	}
+
+	template<>
+	ptr_type<ast::BaseExpr> fold_expression<ast::ReturnExpr>(ast::ReturnExpr* expr)
+	{
+		if (expr->ret_expr != nullptr)
+		{
+			fold_expression_dispatch(expr->ret_expr);
+		}
+		return nullptr;
+	}
+
+	template<>
+	ptr_type<ast::BaseExpr> fold_expression<ast::ContinueExpr>(ast::ContinueExpr* expr)
+	{
+		return nullptr;
+	}
+
+	template<>
+	ptr_type<ast::BaseExpr> fold_expression<ast::BreakExpr>(ast::BreakExpr* expr)
+	{
+		return nullptr;
+	}
+
+	template<>
+	ptr_type<ast::BaseExpr> fold_expression<ast::UnaryExpr>(ast::UnaryExpr* expr)
+	{
+		fold_expression_dispatch(expr->expr);
+
+		const ast::LiteralExpr* literal = ast::dyn_expr_cast<ast::LiteralExpr>(expr->expr.get());
+		if (literal == nullptr)
+		{
+			return nullptr;
+		}
+
+		types::Type type = expr->get_result_type();
+
+		switch (expr->unop)
+		{
+			case operators::UnaryOp::Plus:
+			{
+				return std::move(expr->expr);
+			}
+			case operators::UnaryOp::Minus:
+			{
+				if (type.get_type_enum() == types::TypeEnum::Int)
+				{
+					return make_int_literal(expr, type, 0 - get_bits(literal));
+				}
+				else if (type.get_type_enum() == types::TypeEnum::Float)
+				{
+					return make_float_literal(expr, type, -get_float(literal));
+				}
+				return nullptr;
+			}
+			case operators::UnaryOp::BooleanNot:
+			{
+				if (type.get_type_enum() == types::TypeEnum::Bool)
+				{
+					return make_bool_literal(expr, !literal->value.bool_value);
+				}
+				return nullptr;
+			}
+			case operators::UnaryOp::BitwiseNot:
+			{
+				if (type.get_type_enum() == types::TypeEnum::Int || type.get_type_enum() == types::TypeEnum::Char ||
+					type.get_type_enum() == types::TypeEnum::Bool)
+				{
+					return make_int_literal(expr, type, ~get_bits(literal));
+				}
+				return nullptr;
+			}
+			default:
+			{
+				return nullptr;
+			}
+		}
+	}
+
+	template<>
+	ptr_type<ast::BaseExpr> fold_expression<ast::CastExpr>(ast::CastExpr* expr)
+	{
+		fold_expression_dispatch(expr->expr);
+
+		const ast::LiteralExpr* literal = ast::dyn_expr_cast<ast::LiteralExpr>(expr->expr.get());
+		if (literal == nullptr)
+		{
+			return nullptr;
+		}
+
+		types::Type from_type = literal->curr_type;
+		types::Type target_type = expr->get_result_type();
+
+		if (from_type == target_type)
+		{
+			return std::move(expr->expr);
+		}
+
+		switch (from_type.get_type_enum())
+		{
+			case types::TypeEnum::Int:
+			case types::TypeEnum::Bool:
+			case types::TypeEnum::Char:
+			{
+				// extending by the sign of the source and then truncating covers every int size and sign cast
+				uint64_t bits = get_extended_bits(literal);
+
+				switch (target_type.get_type_enum())
+				{
+					case types::TypeEnum::Int:
+					case types::TypeEnum::Char:
+					{
+						return make_int_literal(expr, target_type, bits);
+					}
+					case types::TypeEnum::Bool:
+					{
+						return make_bool_literal(expr, bits != 0);
+					}
+					case types::TypeEnum::Float:
+					{
+						// converted straight to the target size, so the value is only rounded once
+						if (target_type.get_size() == 32)
+						{
+							float value = from_type.is_signed() ? static_cast<float>(static_cast<int64_t>(bits))
+																: static_cast<float>(bits);
+							return make_float_literal(expr, target_type, value);
+						}
+
+						double value = from_type.is_signed() ? static_cast<double>(static_cast<int64_t>(bits))
+															 : static_cast<double>(bits);
+						return make_float_literal(expr, target_type, value);
+					}
+					default:
+					{
+						return nullptr;
+					}
+				}
+			}
+			case types::TypeEnum::Float:
+			{
+				double value = get_float(literal);
+
+				switch (target_type.get_type_enum())
+				{
+					case types::TypeEnum::Int:
+					case types::TypeEnum::Char:
+					{
+						// values that don't fit in the target are undefined, so they are left for runtime
+						if (std::isnan(value))
+						{
+							return nullptr;
+						}
+
+						double truncated_value = std::trunc(value);
+						int width = target_type.get_size();
+
+						if (target_type.is_signed())
+						{
+							double limit = std::ldexp(1.0, width - 1);
+							if (truncated_value < -limit || truncated_value >= limit)
+							{
+								return nullptr;
+							}
+							return make_int_literal(
+								expr,
+								target_type,
+								static_cast<uint64_t>(static_cast<int64_t>(truncated_value)));
+						}
+						else
+						{
+							double limit = std::ldexp(1.0, width);
+							if (truncated_value < 0 || truncated_value >= limit)
+							{
+								return nullptr;
+							}
+							return make_int_literal(expr, target_type, static_cast<uint64_t>(truncated_value));
+						}
+					}
+					case types::TypeEnum::Float:
+					{
+						return make_float_literal(expr, target_type, value);
+					}
+					default:
+					{
+						return nullptr;
+					}
+				}
+			}
+			default:
+			{
+				return nullptr;
+			}
+		}
+	}
+
+	template<>
+	ptr_type<ast::BaseExpr> fold_expression<ast::CaseExpr>(ast::CaseExpr* expr)
+	{
+		fold_expression_dispatch(expr->case_body);
+		return nullptr;
+	}
+
+	template<>
+	ptr_type<ast::BaseExpr> fold_expression<ast::SwitchExpr>(ast::SwitchExpr* expr)
+	{
+		fold_expression_dispatch(expr->value_expr);
+		for (auto& e : expr->cases)
+		{
+			fold_expression(e.get());
+		}
+
+		const ast::LiteralExpr* value = ast::dyn_expr_cast<ast::LiteralExpr>(expr->value_expr.get());
+		if (value == nullptr)
+		{
+			return nullptr;
+		}
+
+		uint64_t value_bits = get_bits(value);
+
+		// find the case that is jumped to
+		size_t taken_case = expr->cases.size();
+		for (size_t i = 0; i < expr->cases.size(); i++)
+		{
+			if (expr->cases[i]->default_case)
+			{
+				if (taken_case == expr->cases.size())
+				{
+					taken_case = i;
+				}
+				continue;
+			}
+
+			// the type checker has made sure each case value is a literal of the switch type
+			const ast::LiteralExpr* case_value = ast::expr_cast<ast::LiteralExpr>(expr->cases[i]->case_expr.get());
+			if (get_bits(case_value) == value_bits)
+			{
+				taken_case = i;
+				break;
+			}
+		}
+
+		ptr_type<ast::BodyExpr> taken_code = make_ptr<ast::BodyExpr>(expr->get_body(), ast::BodyType::ScopeBlock);
+
+		if (taken_case == expr->cases.size())
+		{
+			// none of the code runs
+			return taken_code;
+		}
+
+		// the cases fall through into the next case, until a case ends with a break
+		size_t last_case = taken_case;
+		while (last_case < expr->cases.size() - 1 && !ends_in_break(expr->cases[last_case]->case_body.get()))
+		{
+			last_case++;
+		}
+
+		// only the break at the end of the last case can be removed, any other jump is left for the builder
+		for (size_t i = taken_case; i <= last_case; i++)
+		{
+			ast::BaseExpr* case_body = expr->cases[i]->case_body.get();
+			ast::BodyExpr* body = ast::dyn_expr_cast<ast::BodyExpr>(case_body);
+
+			if (body == nullptr)
+			{
+				if (contains_jump(case_body))
+				{
+					return nullptr;
+				}
+				continue;
+			}
+
+			size_t expression_count = body->expressions.size() - (ends_in_break(case_body) ? 1 : 0);
+			for (size_t j = 0; j < expression_count; j++)
+			{
+				if (contains_jump(body->expressions[j].get()))
+				{
+					return nullptr;
+				}
+			}
+		}
+
+		for (size_t i = taken_case; i <= last_case; i++)
+		{
+			if (ends_in_break(expr->cases[i]->case_body.get()))
+			{
+				ast::expr_cast<ast::BodyExpr>(expr->cases[i]->case_body.get())->expressions.pop_back();
+			}
+			taken_code->add_base(std::move(expr->cases[i]->case_body));
+		}
+
+		if (taken_code->expressions.size() == 1)
+		{
+			return std::move(taken_code->expressions[0]);
+		}
+
+		return taken_code;
+	}
+
+	void fold_body(ast::BodyExpr* body)
+	{
+		fold_expression(body);
+	}
+
+	void fold_expression_dispatch(ptr_type<ast::BaseExpr>& expr)
+	{
+		ptr_type<ast::BaseExpr> folded = ast::visit(expr.get(), [](auto* e) { return fold_expression(e); });
+
+		if (folded != nullptr)
+		{
+			expr = std::move(folded);
+		}
+	}
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "ast.h"
+
+// Evaluates the constant expressions after the checks have run, and replaces them with literals.
+// The if and switch exprs with a constant condition are replaced with the code that would run.
+namespace constant_folder
+{
+	void fold_body(ast::BodyExpr* body);
+	// replaces the expr if it can be folded
+	void fold_expression_dispatch(ptr_type<ast::BaseExpr>& expr);
+
+	// returns the expr to replace the given expr with, or nullptr to keep it
+	template<class T, typename = std::enable_if_t<std::is_base_of_v<ast::BaseExpr, T>>>
+	ptr_type<ast::BaseExpr> fold_expression(T* expr);
+}
@@ -0,0 +1,385 @@
+#include "lexer.h"
+
+#include <array>
+#include <string>
+
+#include "scanner.h"
+#include "string_manager.h"
+
+namespace parser
+{
+	namespace
+	{
+		// character classes, a character can be in more than one class
+		// the runs of whitespace, identifiers and comments are scanned by the scanner
+		enum CharClass : uint8_t
+		{
+			IdentifierStart = 1 << 0,
+			Digit = 1 << 1,
+			// the characters that can be part of a number literal [0-9.fiu]
+			NumberContinue = 1 << 2,
+		};
+
+		constexpr std::array<uint8_t, 256> make_char_classes()
+		{
+			std::array<uint8_t, 256> table{};
+
+			for (int c = 'a'; c <= 'z'; c++)
+			{
+				table[c] |= IdentifierStart;
+			}
+			for (int c = 'A'; c <= 'Z'; c++)
+			{
+				table[c] |= IdentifierStart;
+			}
+			table['_'] |= IdentifierStart;
+
+			for (int c = '0'; c <= '9'; c++)
+			{
+				table[c] |= Digit | NumberContinue;
+			}
+			for (char c : {'.', 'f', 'i', 'u'})
+			{
+				table[static_cast<unsigned char>(c)] |= NumberContinue;
+			}
+
+			return table;
+		}
+
+		constexpr std::array<uint8_t, 256> char_classes = make_char_classes();
+
+		constexpr bool is_char_class(char c, uint8_t char_class)
+		{
+			return (char_classes[static_cast<unsigned char>(c)] & char_class) != 0;
+		}
+
+		// the tokens that are always a single character
+		constexpr std::array<Token, 256> make_single_char_tokens()
+		{
+			std::array<Token, 256> table{};
+			for (Token& token : table)
+			{
+				token = Token::None;
+			}
+			table[';'] = Token::EndOfExpression;
+			table['{'] = Token::BodyStart;
+			table['}'] = Token::BodyEnd;
+			table['('] = Token::ParenStart;
+			table[')'] = Token::ParenEnd;
+			return table;
+		}
+
+		constexpr std::array<Token, 256> single_char_tokens = make_single_char_tokens();
+
+		class Keyword
+		{
+		public:
+			std::string_view name;
+			Token token = Token::None;
+		};
+
+		// clang-format off
+		constexpr Keyword keywords[] = {
+			{"function", Token::FunctionDefinition},
+			{"extern",   Token::ExternFunction},
+			{"if",       Token::IfStatement},
+			{"else",     Token::ElseStatement},
+			{"var",      Token::VariableDeclaration},
+			{"for",      Token::ForStatement},
+			{"while",    Token::WhileStatement},
+			{"return",   Token::ReturnStatement},
+			{"continue", Token::ContinueStatement},
+			{"break",    Token::BreakStatement},
+			{"module",   Token::ModuleStatement},
+			{"using",    Token::UsingStatement},
+			{"switch",   Token::SwitchStatement},
+			{"case",     Token::CaseStatement},
+			{"default",  Token::DefaultStatement},
+			// the bool literals
+			{"true",     Token::LiteralValue},
+			{"false",    Token::LiteralValue},
+		};
+		// clang-format on
+
+		constexpr size_t KeywordTableSize = 32;
+
+		// a perfect hash for the keywords above, all of the keywords are at least 2 characters long
+		constexpr size_t keyword_hash(std::string_view str)
+		{
+			return (str.length() + static_cast<unsigned char>(str[0]) * 4 + static_cast<unsigned char>(str[1]) * 3) &
+				   (KeywordTableSize - 1);
+		}
+
+		constexpr std::array<Keyword, KeywordTableSize> make_keyword_table()
+		{
+			std::array<Keyword, KeywordTableSize> table{};
+			for (const Keyword& keyword : keywords)
+			{
+				table[keyword_hash(keyword.name)] = keyword;
+			}
+			return table;
+		}
+
+		constexpr std::array<Keyword, KeywordTableSize> keyword_table = make_keyword_table();
+
+		constexpr bool is_keyword_hash_perfect()
+		{
+			for (const Keyword& keyword : keywords)
+			{
+				if (keyword_table[keyword_hash(keyword.name)].name != keyword.name)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		static_assert(is_keyword_hash_perfect(), "Keyword hash has a collision");
+
+		// returns Token::None if the identifier is not a keyword
+		constexpr Token find_keyword(std::string_view identifier)
+		{
+			if (identifier.length() < 2)
+			{
+				return Token::None;
+			}
+
+			const Keyword& keyword = keyword_table[keyword_hash(identifier)];
+			if (keyword.name == identifier)
+			{
+				return keyword.token;
+			}
+			return Token::None;
+		}
+	}
+
+	Lexer::Lexer(const char* buffer_start, const char* buffer_end) :
+		buffer_start(buffer_start),
+		buffer_end(buffer_end),
+		buffer_ptr(buffer_start)
+	{}
+
+	std::vector<LexedToken> Lexer::tokenize()
+	{
+		std::vector<LexedToken> tokens;
+
+		// rough guess of one token every 4 bytes, to avoid most of the re-allocations
+		tokens.reserve((buffer_end - buffer_start) / 4 + 1);
+
+		while (true)
+		{
+			tokens.push_back(lex_token());
+
+			if (tokens.back().token == Token::EndOfFile)
+			{
+				break;
+			}
+		}
+
+		return tokens;
+	}
+
+	void Lexer::seek(uint32_t offset)
+	{
+		buffer_ptr = buffer_start + offset;
+	}
+
+	bool Lexer::has_identifier_string(Token token)
+	{
+		switch (token)
+		{
+			case Token::EndOfFile:
+			case Token::EndOfExpression:
+			case Token::BodyStart:
+			case Token::BodyEnd:
+			case Token::ParenStart:
+			case Token::ParenEnd:
+			case Token::AngleStart:
+			case Token::AngleEnd:
+			case Token::Comma:
+			case Token::Comment:
+			case Token::None:
+			{
+				return false;
+			}
+			default:
+			{
+				return true;
+			}
+		}
+	}
+
+	LexedToken Lexer::make_token(Token token, const char* token_start) const
+	{
+		LexedToken lexed_token;
+		lexed_token.token = token;
+		lexed_token.offset = static_cast<uint32_t>(token_start - buffer_start);
+		lexed_token.length = static_cast<uint32_t>(buffer_ptr - token_start);
+		return lexed_token;
+	}
+
+	LexedToken Lexer::lex_token()
+	{
+		// skip whitespace
+		buffer_ptr = scanner::skip_whitespace(buffer_ptr, buffer_end);
+
+		const char* token_start = buffer_ptr;
+
+		// end of file
+		if (buffer_ptr == buffer_end)
+		{
+			return make_token(Token::EndOfFile, token_start);
+		}
+
+		char last_char = *buffer_ptr++;
+
+		// identifier: [a-zA-Z_][a-zA-Z0-9_]*
+		if (is_char_class(last_char, IdentifierStart))
+		{
+			buffer_ptr = scanner::skip_identifier(buffer_ptr, buffer_end);
+
+			std::string_view identifier_string{token_start, static_cast<size_t>(buffer_ptr - token_start)};
+
+			Token keyword = find_keyword(identifier_string);
+			if (keyword == Token::LiteralValue)
+			{
+				// the identifier is a bool
+				LexedToken token = make_token(Token::LiteralValue, token_start);
+				token.literal.type = types::Type{types::TypeEnum::Bool};
+				token.literal.value.bool_value = identifier_string == "true";
+				return token;
+			}
+			else if (keyword != Token::None)
+			{
+				return make_token(keyword, token_start);
+			}
+
+			LexedToken token = make_token(Token::VariableReference, token_start);
+			token.identifier_id = stringManager::get_id(identifier_string);
+			return token;
+		}
+
+		// literal:
+		//		int: [0-9][0-9]*((i|u)(8|16|32|64)?)?
+		//		float: ([0-9][0-9]*)[.]([0-9][0-9]*)(f(32|64)?)?
+		if (is_char_class(last_char, Digit))
+		{
+			while (buffer_ptr != buffer_end && is_char_class(*buffer_ptr, NumberContinue))
+			{
+				buffer_ptr++;
+			}
+
+			types::Literal literal =
+				types::check_type_string(std::string_view{token_start, static_cast<size_t>(buffer_ptr - token_start)});
+
+			if (literal.type.get_type_enum() != types::TypeEnum::None)
+			{
+				LexedToken token = make_token(Token::LiteralValue, token_start);
+				token.literal = literal;
+				return token;
+			}
+
+			// not a valid literal
+			return make_token(Token::None, token_start);
+		}
+
+		// literal:
+		//		char: '.'
+		if (last_char == '\'')
+		{
+			// a char literal can not span multiple lines
+			while (buffer_ptr != buffer_end && *buffer_ptr != '\'' && *buffer_ptr != '\n')
+			{
+				// skip over the escaped character
+				if (*buffer_ptr == '\\' && buffer_ptr + 1 != buffer_end)
+				{
+					buffer_ptr++;
+				}
+				buffer_ptr++;
+			}
+
+			// eat the closing '\''
+			if (buffer_ptr != buffer_end && *buffer_ptr == '\'')
+			{
+				buffer_ptr++;
+			}
+
+			types::Literal literal =
+				types::check_type_string(std::string_view{token_start, static_cast<size_t>(buffer_ptr - token_start)});
+
+			if (literal.type.get_type_enum() != types::TypeEnum::None)
+			{
+				LexedToken token = make_token(Token::LiteralValue, token_start);
+				token.literal = literal;
+				return token;
+			}
+
+			// not a valid literal
+			return make_token(Token::None, token_start);
+		}
+
+		// end of expression, start/end of body, paren start/end
+		Token single_char_token = single_char_tokens[static_cast<unsigned char>(last_char)];
+		if (single_char_token != Token::None)
+		{
+			return make_token(single_char_token, token_start);
+		}
+
+		// binary operator
+		if (operators::is_first_char_valid(last_char))
+		{
+			// if the next character could be part of an operator, only the two character operator is checked
+			operators::BinaryOp binop;
+			if (buffer_ptr != buffer_end && operators::is_second_char_valid(*buffer_ptr))
+			{
+				binop = operators::get_binary_op(last_char, *buffer_ptr);
+				if (binop != operators::BinaryOp::None)
+				{
+					buffer_ptr++;
+				}
+			}
+			else
+			{
+				binop = operators::get_binary_op(last_char);
+			}
+
+			if (binop != operators::BinaryOp::None)
+			{
+				LexedToken token = make_token(Token::BinaryOperator, token_start);
+				token.binop = binop;
+				return token;
+			}
+		}
+
+		// angle start
+		if (last_char == '<')
+		{
+			return make_token(Token::AngleStart, token_start);
+		}
+
+		// angle end
+		if (last_char == '>')
+		{
+			return make_token(Token::AngleEnd, token_start);
+		}
+
+		// comma
+		if (last_char == ',')
+		{
+			return make_token(Token::Comma, token_start);
+		}
+
+		// comment, the token is just the '#' but the rest of the line is skipped
+		if (last_char == '#')
+		{
+			LexedToken token = make_token(Token::Comment, token_start);
+
+			buffer_ptr = scanner::skip_line(buffer_ptr, buffer_end);
+
+			return token;
+		}
+
+		// anything else
+		return make_token(Token::None, token_start);
+	}
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "operators.h"
+#include "types.h"
+
+namespace parser
+{
+	enum class Token
+	{
+		EndOfFile,
+		EndOfExpression,
+		VariableDeclaration,
+		VariableReference,
+		LiteralValue,
+		BinaryOperator,
+		FunctionDefinition,
+		ExternFunction,
+		IfStatement,
+		ElseStatement,
+		ForStatement,
+		WhileStatement,
+		ReturnStatement,
+		ContinueStatement,
+		BreakStatement,
+		SwitchStatement,
+		CaseStatement,
+		DefaultStatement,
+		ModuleStatement,
+		UsingStatement,
+		BodyStart,
+		BodyEnd,
+		ParenStart,
+		ParenEnd,
+		AngleStart,
+		AngleEnd,
+		Comma,
+		Comment,
+		None,
+	};
+
+	// A single lexed token, the text of the token is not stored,
+	// it can be recovered from the source buffer using the offset and length.
+	class LexedToken
+	{
+	public:
+		Token token = Token::None;
+		// the binary operator, when token is a BinaryOperator
+		operators::BinaryOp binop = operators::BinaryOp::None;
+		// the interned string id, when token is a VariableReference
+		int identifier_id = -1;
+		// the type and parsed value of the literal, when token is a LiteralValue
+		types::Literal literal;
+		// the byte offset of the first character of the token in the source buffer
+		uint32_t offset = 0;
+		uint32_t length = 0;
+	};
+
+	// Converts a whole source buffer into a flat array of tokens in a single pass,
+	// the last token is always an EndOfFile token.
+	class Lexer
+	{
+	public:
+		Lexer(const char* buffer_start, const char* buffer_end);
+
+		std::vector<LexedToken> tokenize();
+		LexedToken lex_token();
+		void seek(uint32_t offset);
+
+		static bool has_identifier_string(Token token);
+
+	private:
+		LexedToken make_token(Token token, const char* token_start) const;
+
+	private:
+		const char* buffer_start;
+		const char* buffer_end;
+		const char* buffer_ptr;
+	};
+}
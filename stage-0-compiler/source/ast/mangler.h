@@ -2,5 +2,7 @@
 
 #include "mangler/mangler_v1.h"
 #include "mangler/mangler_v2.h"
+#include "mangler/mangler_v3.h"
 
+// manglerV3 gives shorter symbols, but the names are not compatible with objects built using manglerV2
 namespace mangler = manglerV2;
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "../types.h"
+
+// The mangled ids that have already been made, shared by the manglers, so a name is only built and interned the
+// first time. Each mangler keeps its own thread_local cache, every thread gets the same ids, as the names are interned.
+namespace mangleCache
+{
+	inline uint64_t make_key(int first, int second)
+	{
+		return (static_cast<uint64_t>(static_cast<uint32_t>(first)) << 32) | static_cast<uint32_t>(second);
+	}
+
+	class FunctionKey
+	{
+	public:
+		int prefix_id;
+		int name_id;
+		int type_list_id;
+
+		bool operator==(const FunctionKey& other) const
+		{
+			return prefix_id == other.prefix_id && name_id == other.name_id && type_list_id == other.type_list_id;
+		}
+	};
+
+	class FunctionKeyHash
+	{
+	public:
+		size_t operator()(const FunctionKey& key) const
+		{
+			uint64_t hash = static_cast<uint32_t>(key.prefix_id);
+			hash = hash * 0x9E3779B97F4A7C15ull + static_cast<uint32_t>(key.name_id);
+			hash = hash * 0x9E3779B97F4A7C15ull + static_cast<uint32_t>(key.type_list_id);
+			return static_cast<size_t>(hash ^ (hash >> 32));
+		}
+	};
+
+	class MangleCache
+	{
+	public:
+		// returns the id of the type list with the type appended, the empty list is 0
+		int get_type_list_id(int type_list_id, const types::Type& type)
+		{
+			auto [f, inserted] = type_lists.insert({make_key(type_list_id, type.get_id()), 0});
+			if (inserted)
+			{
+				f->second = static_cast<int>(type_lists.size());
+			}
+
+			return f->second;
+		}
+
+	public:
+		// (type list id, type) -> type list id
+		std::unordered_map<uint64_t, int> type_lists;
+		// (prefix id, function name id, type list id) -> mangled function id
+		std::unordered_map<FunctionKey, int, FunctionKeyHash> functions;
+		// (prefix id, module name id) -> mangled module id
+		std::unordered_map<uint64_t, int> modules;
+		// (prefix id, mangled name id) -> mangled name id
+		std::unordered_map<uint64_t, int> mangled_names;
+	};
+}
@@ -1,6 +1,7 @@
 #include "mangler_v1.h"
 
 #include "../string_manager.h"
+#include "../visitor.h"
 
 #include <string>
 
@@ -109,17 +110,18 @@ int manglerV1::mangle_using(const ast::BinaryExpr* scope_expr)
 	// add lhs
 	if (scope_expr->lhs->get_type() == ast::AstExprType::BinaryExpr)
 	{
-		modules += stringManager::get_string(mangle_using(dynamic_cast<ast::BinaryExpr*>(scope_expr->lhs.get())));
+		modules += stringManager::get_string(mangle_using(ast::expr_cast<ast::BinaryExpr>(scope_expr->lhs.get())));
 	}
 	else
 	{
-		modules += stringManager::get_string(dynamic_cast<ast::VariableReferenceExpr*>(scope_expr->lhs.get())->name_id);
+		modules +=
+			stringManager::get_string(ast::expr_cast<ast::VariableReferenceExpr>(scope_expr->lhs.get())->name_id);
 	}
 
 	modules += '_';
 
 	// add rhs
-	modules += stringManager::get_string(dynamic_cast<ast::VariableReferenceExpr*>(scope_expr->rhs.get())->name_id);
+	modules += stringManager::get_string(ast::expr_cast<ast::VariableReferenceExpr>(scope_expr->rhs.get())->name_id);
 
 	return stringManager::get_id(modules);
 }
@@ -128,7 +130,7 @@ int manglerV1::extract_module(int function_id)
 {
 	std::string module_name;
 
-	const std::string& name = stringManager::get_string(function_id);
+	std::string_view name = stringManager::get_string(function_id);
 
 	for (int i = 0; i < name.length(); i++)
 	{
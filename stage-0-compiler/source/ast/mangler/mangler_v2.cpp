@@ -1,70 +1,104 @@
 #include "mangler_v2.h"
 
+#include "mangle_cache.h"
+#include "../module_manager.h"
 #include "../string_manager.h"
+#include "../visitor.h"
 
 namespace manglerV2
 {
 	static constexpr const char* StartString = "_AS_";
 	static constexpr size_t StartStringSize = 4;
-	std::string remove_start_string(const std::string& string);
+	// the prefix id of names that are mangled without a module or the start string, -1 is the start string
+	static constexpr int NoPrefix = -2;
+
+	static thread_local mangleCache::MangleCache cache;
+
+	int mangle_function_id(int prefix_id, int function_id, int type_list_id, const std::vector<types::Type>& types);
+	int append_module(int prefix_id, int module_name_id);
+	std::string remove_start_string(std::string_view string);
 	std::string get_name_or_start(int name_id);
 	std::string mangle_function(int function_id, const std::vector<types::Type>& types);
 	std::string mangle_type(const types::Type& type);
-	std::string mangle_call(const ast::CallExpr* expr);
 }
 
 int manglerV2::mangle(int current_module_id, const ast::FunctionPrototype* proto)
 {
-	std::string name = get_name_or_start(current_module_id);
-
-	name += mangle_function(proto->name_id, proto->types);
-
-	return stringManager::get_id(name);
+	return mangle(current_module_id, proto->name_id, proto->types);
 }
 
 int manglerV2::mangle(int current_module_id, const ast::CallExpr* expr)
 {
-	std::string name = get_name_or_start(current_module_id);
+	int type_list_id = 0;
+	for (auto& e : expr->args)
+	{
+		type_list_id = cache.get_type_list_id(type_list_id, e->get_result_type());
+	}
 
-	name += mangle_call(expr);
+	auto f = cache.functions.find(mangleCache::FunctionKey{current_module_id, expr->callee_id, type_list_id});
+	if (f != cache.functions.end())
+	{
+		return f->second;
+	}
 
-	return stringManager::get_id(name);
+	// the arg types are only collected the first time the name is made
+	std::vector<types::Type> types;
+	for (auto& e : expr->args)
+	{
+		types.push_back(e->get_result_type());
+	}
+
+	return mangle_function_id(current_module_id, expr->callee_id, type_list_id, types);
 }
 
 int manglerV2::mangle(const ast::CallExpr* expr)
 {
-	std::string name = mangle_call(expr);
-	return stringManager::get_id(name);
+	return mangle(NoPrefix, expr);
+}
+
+int manglerV2::mangle(const ast::FunctionPrototype* proto)
+{
+	return mangle(NoPrefix, proto->name_id, proto->types);
 }
 
 int manglerV2::mangle(int current_module_id, int function_id, const std::vector<types::Type>& function_args)
 {
-	std::string name = get_name_or_start(current_module_id);
+	int type_list_id = 0;
+	for (auto& type : function_args)
+	{
+		type_list_id = cache.get_type_list_id(type_list_id, type);
+	}
 
-	name += mangle_function(function_id, function_args);
+	auto f = cache.functions.find(mangleCache::FunctionKey{current_module_id, function_id, type_list_id});
+	if (f != cache.functions.end())
+	{
+		return f->second;
+	}
 
-	return stringManager::get_id(name);
+	return mangle_function_id(current_module_id, function_id, type_list_id, function_args);
 }
 
 int manglerV2::add_module(int current_module_id, int other_module_id)
 {
-	std::string name = get_name_or_start(current_module_id);
-
-	std::string module_name = stringManager::get_string(other_module_id);
-
-	// module = M<char length><name>
-	name += 'M';
-	name += std::to_string(module_name.size());
-	name += module_name;
-
-	return stringManager::get_id(name);
+	return append_module(current_module_id, other_module_id);
 }
 
 int manglerV2::add_mangled_name(int current_module_id, int mangled_name_id)
 {
+	uint64_t key = mangleCache::make_key(current_module_id, mangled_name_id);
+
+	auto f = cache.mangled_names.find(key);
+	if (f != cache.mangled_names.end())
+	{
+		return f->second;
+	}
+
 	std::string name = get_name_or_start(current_module_id);
 	name += stringManager::get_string(mangled_name_id);
-	return stringManager::get_id(name);
+
+	int id = stringManager::get_id(name);
+	cache.mangled_names.insert({key, id});
+	return id;
 }
 
 int manglerV2::mangle_using(const ast::BinaryExpr* scope_expr)
@@ -74,80 +108,35 @@ int manglerV2::mangle_using(const ast::BinaryExpr* scope_expr)
 		assert(false && "ManglerV2::mangle_using, Scope Expression has invalid binop.");
 	}
 
-	std::string modules;
+	int modules_id = -1;
 
 	// add lhs
 	if (scope_expr->lhs->get_type() == ast::AstExprType::BinaryExpr)
 	{
-		modules += stringManager::get_string(mangle_using(dynamic_cast<ast::BinaryExpr*>(scope_expr->lhs.get())));
+		modules_id = mangle_using(ast::expr_cast<ast::BinaryExpr>(scope_expr->lhs.get()));
 	}
 	else
 	{
-		std::string name =
-			stringManager::get_string(dynamic_cast<ast::VariableReferenceExpr*>(scope_expr->lhs.get())->name_id);
-		modules += 'M';
-		modules += std::to_string(name.size());
-		modules += name;
+		modules_id = append_module(
+			NoPrefix,
+			ast::expr_cast<ast::VariableReferenceExpr>(scope_expr->lhs.get())->name_id);
 	}
 
 	// add rhs
-	std::string name =
-		stringManager::get_string(dynamic_cast<ast::VariableReferenceExpr*>(scope_expr->rhs.get())->name_id);
-	modules += 'M';
-	modules += std::to_string(name.size());
-	modules += name;
-
-	return stringManager::get_id(modules);
+	return append_module(modules_id, ast::expr_cast<ast::VariableReferenceExpr>(scope_expr->rhs.get())->name_id);
 }
 
 int manglerV2::extract_module(int function_id)
 {
-	std::string mangled_name = stringManager::get_string(function_id);
-
-	size_t i = StartStringSize;
-
-	std::string module_string = StartString;
-
-	// module = M<char length><name>
-
-	while (i < mangled_name.size())
+	// the module is kept in the symbol of the function, so the mangled name doesn't need parsing
+	const moduleManager::FunctionSymbol* symbol = moduleManager::find_function_symbol(function_id);
+	if (symbol == nullptr)
 	{
-		if (mangled_name[i] == 'M')
-		{
-			size_t module_start = i;
-			i++;
-			std::string count_str;
-			count_str = mangled_name[i];
-			i++;
-
-			while (mangled_name[i] >= '0' && mangled_name[i] <= '9')
-			{
-				count_str += mangled_name[i];
-				i++;
-
-				if (i >= mangled_name.size())
-				{
-					assert("ManglerV2::extract_module out of range (getting count )" && false);
-				}
-			}
-
-			int count = std::stoi(count_str);
-
-			if (i + count > mangled_name.size())
-			{
-				assert("ManglerV2::extract_module out of range (getting chars)" && false);
-			}
-
-			i += count;
-			module_string += mangled_name.substr(module_start, i - module_start);
-		}
-		else
-		{
-			break;
-		}
+		assert("ManglerV2::extract_module, id is not a function" && false);
+		return -1;
 	}
 
-	return stringManager::get_id(module_string);
+	return symbol->module_id;
 }
 
 std::string manglerV2::pretty_modules(int module_id)
@@ -207,29 +196,69 @@ std::string manglerV2::pretty_modules(int module_id)
 	return pretty_string;
 }
 
-std::string manglerV2::remove_start_string(const std::string& string)
+std::string manglerV2::remove_start_string(std::string_view string)
 {
-	std::string start{ StartString };
+	std::string_view start{ StartString };
 
-	if (string.rfind(start, 0) == std::string::npos)
+	if (string.substr(0, start.size()) != start)
 	{
 		assert("String does not begin with start text" && false);
 	}
 
-	std::string removed_string{ string };
-	removed_string.erase(0, start.size());
-	return removed_string;
+	return std::string{ string.substr(start.size()) };
+}
+
+int manglerV2::mangle_function_id(
+	int prefix_id,
+	int function_id,
+	int type_list_id,
+	const std::vector<types::Type>& types)
+{
+	std::string name = get_name_or_start(prefix_id);
+	name += mangle_function(function_id, types);
+
+	int id = stringManager::get_id(name);
+	cache.functions.insert({mangleCache::FunctionKey{prefix_id, function_id, type_list_id}, id});
+	return id;
+}
+
+int manglerV2::append_module(int prefix_id, int module_name_id)
+{
+	uint64_t key = mangleCache::make_key(prefix_id, module_name_id);
+
+	auto f = cache.modules.find(key);
+	if (f != cache.modules.end())
+	{
+		return f->second;
+	}
+
+	std::string name = get_name_or_start(prefix_id);
+
+	std::string_view module_name = stringManager::get_string(module_name_id);
+
+	// module = M<char length><name>
+	name += 'M';
+	name += std::to_string(module_name.size());
+	name += module_name;
+
+	int id = stringManager::get_id(name);
+	cache.modules.insert({key, id});
+	return id;
 }
 
 std::string manglerV2::get_name_or_start(int name_id)
 {
-	if (name_id == -1)
+	if (name_id == NoPrefix)
+	{
+		return "";
+	}
+	else if (name_id == -1)
 	{
 		return StartString;
 	}
 	else
 	{
-		return stringManager::get_string(name_id);
+		return std::string{stringManager::get_string(name_id)};
 	}
 }
 
@@ -239,7 +268,7 @@ std::string manglerV2::mangle_function(int function_id, const std::vector<types:
 
 	std::string name = "F";
 
-	std::string function_name = stringManager::get_string(function_id);
+	std::string_view function_name = stringManager::get_string(function_id);
 
 	// add function name
 	name += std::to_string(function_name.size());
@@ -274,14 +303,3 @@ std::string manglerV2::mangle_type(const types::Type& type)
 
 	return name;
 }
-
-std::string manglerV2::mangle_call(const ast::CallExpr* expr)
-{
-	std::vector<types::Type> types;
-	for (auto& e : expr->args)
-	{
-		types.push_back(e->get_result_type());
-	}
-
-	return mangle_function(expr->callee_id, types);
-}
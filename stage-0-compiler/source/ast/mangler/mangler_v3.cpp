@@ -0,0 +1,637 @@
+#include "mangler_v3.h"
+
+#include <cassert>
+#include <cstdint>
+
+#include "mangle_cache.h"
+#include "../module_manager.h"
+#include "../string_manager.h"
+#include "../visitor.h"
+
+// name = _A<module>*F<function>  or  _AH<hash><first chars of the name> if the name is too long
+// module = <char length><name>  or  S<index>_ to refer back to an earlier module with the same name
+// function = <char length><name><types>
+// types = v (no params)  or  <type code>*
+namespace manglerV3
+{
+	static constexpr std::string_view StartString = "_A";
+	static constexpr std::string_view HashedStartString = "_AH";
+	// the prefix id of names that are mangled without a module or the start string, -1 is the start string
+	static constexpr int NoPrefix = -2;
+	// longer function names are cut down to this length, with a hash of the full name at the start
+	static constexpr size_t MaxNameLength = 128;
+	static constexpr size_t HashLength = 16;
+
+	static thread_local mangleCache::MangleCache cache;
+
+	int mangle_function_id(int prefix_id, int function_id, int type_list_id, const std::vector<types::Type>& types);
+	int append_module(int prefix_id, int module_name_id);
+	std::string get_name_or_start(int name_id);
+	std::string hash_name(const std::string& name);
+	std::string mangle_type(const types::Type& type);
+	bool demangle_length_name(std::string_view string, size_t& i, std::string_view& name);
+	bool demangle_modules(std::string_view string, size_t& i, std::vector<std::string_view>& modules);
+	bool demangle_types(std::string_view string, size_t& i, std::string& types);
+	std::string join_modules(const std::vector<std::string_view>& modules);
+}
+
+int manglerV3::mangle(int current_module_id, const ast::FunctionPrototype* proto)
+{
+	return mangle(current_module_id, proto->name_id, proto->types);
+}
+
+int manglerV3::mangle(int current_module_id, const ast::CallExpr* expr)
+{
+	int type_list_id = 0;
+	for (auto& e : expr->args)
+	{
+		type_list_id = cache.get_type_list_id(type_list_id, e->get_result_type());
+	}
+
+	auto f = cache.functions.find(mangleCache::FunctionKey{current_module_id, expr->callee_id, type_list_id});
+	if (f != cache.functions.end())
+	{
+		return f->second;
+	}
+
+	// the arg types are only collected the first time the name is made
+	std::vector<types::Type> types;
+	for (auto& e : expr->args)
+	{
+		types.push_back(e->get_result_type());
+	}
+
+	return mangle_function_id(current_module_id, expr->callee_id, type_list_id, types);
+}
+
+int manglerV3::mangle(const ast::CallExpr* expr)
+{
+	return mangle(NoPrefix, expr);
+}
+
+int manglerV3::mangle(const ast::FunctionPrototype* proto)
+{
+	return mangle(NoPrefix, proto->name_id, proto->types);
+}
+
+int manglerV3::mangle(int current_module_id, int function_id, const std::vector<types::Type>& function_args)
+{
+	int type_list_id = 0;
+	for (auto& type : function_args)
+	{
+		type_list_id = cache.get_type_list_id(type_list_id, type);
+	}
+
+	auto f = cache.functions.find(mangleCache::FunctionKey{current_module_id, function_id, type_list_id});
+	if (f != cache.functions.end())
+	{
+		return f->second;
+	}
+
+	return mangle_function_id(current_module_id, function_id, type_list_id, function_args);
+}
+
+int manglerV3::add_module(int current_module_id, int other_module_id)
+{
+	return append_module(current_module_id, other_module_id);
+}
+
+int manglerV3::add_mangled_name(int current_module_id, int mangled_name_id)
+{
+	uint64_t key = mangleCache::make_key(current_module_id, mangled_name_id);
+
+	auto f = cache.mangled_names.find(key);
+	if (f != cache.mangled_names.end())
+	{
+		return f->second;
+	}
+
+	// the back references in the name are relative to its own modules,
+	// so the modules are added one at a time, to give the same name as add_module would
+	std::string_view mangled_name = stringManager::get_string(mangled_name_id);
+	std::vector<std::string_view> modules;
+	size_t i = 0;
+	if (!demangle_modules(mangled_name, i, modules) || i != mangled_name.size())
+	{
+		assert("ManglerV3::add_mangled_name, name is not a list of modules" && false);
+	}
+
+	int id = current_module_id;
+	for (std::string_view module : modules)
+	{
+		id = append_module(id, stringManager::get_id(module));
+	}
+
+	cache.mangled_names.insert({key, id});
+	return id;
+}
+
+int manglerV3::mangle_using(const ast::BinaryExpr* scope_expr)
+{
+	if (scope_expr->binop != operators::BinaryOp::ModuleScope)
+	{
+		assert(false && "ManglerV3::mangle_using, Scope Expression has invalid binop.");
+	}
+
+	int modules_id = -1;
+
+	// add lhs
+	if (scope_expr->lhs->get_type() == ast::AstExprType::BinaryExpr)
+	{
+		modules_id = mangle_using(ast::expr_cast<ast::BinaryExpr>(scope_expr->lhs.get()));
+	}
+	else
+	{
+		modules_id = append_module(
+			NoPrefix,
+			ast::expr_cast<ast::VariableReferenceExpr>(scope_expr->lhs.get())->name_id);
+	}
+
+	// add rhs
+	return append_module(modules_id, ast::expr_cast<ast::VariableReferenceExpr>(scope_expr->rhs.get())->name_id);
+}
+
+int manglerV3::extract_module(int function_id)
+{
+	// the module is kept in the symbol of the function, so the mangled name doesn't need parsing
+	const moduleManager::FunctionSymbol* symbol = moduleManager::find_function_symbol(function_id);
+	if (symbol == nullptr)
+	{
+		assert("ManglerV3::extract_module, id is not a function" && false);
+		return -1;
+	}
+
+	return symbol->module_id;
+}
+
+std::string manglerV3::pretty_modules(int module_id)
+{
+	if (module_id == -1)
+	{
+		return "";
+	}
+
+	std::string_view module_string = stringManager::get_string(module_id);
+
+	if (module_string.substr(0, StartString.size()) != StartString)
+	{
+		assert("String does not begin with start text" && false);
+	}
+
+	std::vector<std::string_view> modules;
+	size_t i = StartString.size();
+	if (!demangle_modules(module_string, i, modules))
+	{
+		assert("ManglerV3::pretty_modules, invalid module name" && false);
+	}
+
+	return join_modules(modules);
+}
+
+std::string manglerV3::demangle(int mangled_id)
+{
+	std::string_view string = stringManager::get_string(mangled_id);
+	std::string_view hash;
+
+	if (string.substr(0, HashedStartString.size()) == HashedStartString)
+	{
+		hash = string.substr(HashedStartString.size(), HashLength);
+		string = string.substr(HashedStartString.size() + hash.size());
+	}
+	else if (string.substr(0, StartString.size()) == StartString)
+	{
+		string = string.substr(StartString.size());
+	}
+	else if (string.empty() || !(string[0] == 'F' || string[0] == 'S' || (string[0] >= '0' && string[0] <= '9')))
+	{
+		// not mangled, e.g. main or an extern function
+		return std::string{string};
+	}
+
+	size_t i = 0;
+	std::vector<std::string_view> modules;
+	bool complete = demangle_modules(string, i, modules);
+
+	std::string name = join_modules(modules);
+
+	if (complete && i < string.size() && string[i] == 'F')
+	{
+		i++;
+
+		std::string_view function_name;
+		complete = demangle_length_name(string, i, function_name);
+
+		if (!name.empty())
+		{
+			name += "::";
+		}
+		name += function_name;
+
+		if (complete)
+		{
+			std::string types;
+			complete = demangle_types(string, i, types);
+
+			name += '(';
+			name += types;
+			if (complete && hash.empty())
+			{
+				name += ')';
+			}
+		}
+	}
+
+	// the end of a hashed name is cut off
+	if (!complete || i != string.size() || !hash.empty())
+	{
+		name += "...";
+	}
+
+	if (!hash.empty())
+	{
+		name += " [";
+		name += hash;
+		name += ']';
+	}
+
+	return name;
+}
+
+int manglerV3::mangle_function_id(
+	int prefix_id,
+	int function_id,
+	int type_list_id,
+	const std::vector<types::Type>& types)
+{
+	std::string name = get_name_or_start(prefix_id);
+
+	std::string_view function_name = stringManager::get_string(function_id);
+
+	// function = F<char length><name><types>
+	name += 'F';
+	name += std::to_string(function_name.size());
+	name += function_name;
+
+	if (types.empty())
+	{
+		name += 'v';
+	}
+
+	for (auto& type : types)
+	{
+		name += mangle_type(type);
+	}
+
+	// only full names are cut down, as the others are used to build other names
+	if (prefix_id != NoPrefix && name.size() > MaxNameLength)
+	{
+		name = hash_name(name);
+	}
+
+	int id = stringManager::get_id(name);
+	cache.functions.insert({mangleCache::FunctionKey{prefix_id, function_id, type_list_id}, id});
+	return id;
+}
+
+int manglerV3::append_module(int prefix_id, int module_name_id)
+{
+	uint64_t key = mangleCache::make_key(prefix_id, module_name_id);
+
+	auto f = cache.modules.find(key);
+	if (f != cache.modules.end())
+	{
+		return f->second;
+	}
+
+	std::string name = get_name_or_start(prefix_id);
+
+	std::string_view module_name = stringManager::get_string(module_name_id);
+
+	std::vector<std::string_view> modules;
+	size_t i = name.substr(0, StartString.size()) == StartString ? StartString.size() : 0;
+	demangle_modules(name, i, modules);
+
+	std::string module_string = std::to_string(module_name.size());
+	module_string += module_name;
+
+	// refer back to the same module name, if it has already been used and it is shorter
+	for (size_t index = 0; index < modules.size(); index++)
+	{
+		if (modules[index] == module_name)
+		{
+			std::string back_reference = 'S' + std::to_string(index) + '_';
+			if (back_reference.size() < module_string.size())
+			{
+				module_string = back_reference;
+			}
+			break;
+		}
+	}
+
+	name += module_string;
+
+	int id = stringManager::get_id(name);
+	cache.modules.insert({key, id});
+	return id;
+}
+
+std::string manglerV3::get_name_or_start(int name_id)
+{
+	if (name_id == NoPrefix)
+	{
+		return "";
+	}
+	else if (name_id == -1)
+	{
+		return std::string{StartString};
+	}
+	else
+	{
+		return std::string{stringManager::get_string(name_id)};
+	}
+}
+
+std::string manglerV3::hash_name(const std::string& name)
+{
+	// 64-bit FNV-1a, so the hash is the same on every platform
+	uint64_t hash = 0xCBF29CE484222325ull;
+	for (char c : name)
+	{
+		hash ^= static_cast<uint8_t>(c);
+		hash *= 0x100000001B3ull;
+	}
+
+	static constexpr char hex_digits[] = "0123456789abcdef";
+
+	std::string hashed_name{HashedStartString};
+	for (int shift = 60; shift >= 0; shift -= 4)
+	{
+		hashed_name += hex_digits[(hash >> shift) & 0xF];
+	}
+
+	// keep the start of the name, so it can still be mostly read back
+	hashed_name += name.substr(StartString.size(), MaxNameLength - hashed_name.size());
+
+	return hashed_name;
+}
+
+std::string manglerV3::mangle_type(const types::Type& type)
+{
+	// type (primitive) = a single char code
+	//	or
+	// type (other) = u<char length><name>
+
+	switch (type.get_type_enum())
+	{
+		case types::TypeEnum::Int:
+		{
+			switch (type.get_size())
+			{
+				case 8:
+				{
+					return type.is_signed() ? "a" : "h";
+				}
+				case 16:
+				{
+					return type.is_signed() ? "s" : "t";
+				}
+				case 32:
+				{
+					return type.is_signed() ? "i" : "j";
+				}
+				case 64:
+				{
+					return type.is_signed() ? "l" : "m";
+				}
+			}
+			break;
+		}
+		case types::TypeEnum::Float:
+		{
+			if (type.get_size() == 32)
+			{
+				return "f";
+			}
+			else if (type.get_size() == 64)
+			{
+				return "d";
+			}
+			break;
+		}
+		case types::TypeEnum::Void:
+		{
+			return "v";
+		}
+		case types::TypeEnum::Bool:
+		{
+			return "b";
+		}
+		case types::TypeEnum::Char:
+		{
+			return "c";
+		}
+		case types::TypeEnum::None:
+		{
+			break;
+		}
+	}
+
+	std::string type_name = type.to_string();
+
+	return 'u' + std::to_string(type_name.size()) + type_name;
+}
+
+bool manglerV3::demangle_length_name(std::string_view string, size_t& i, std::string_view& name)
+{
+	size_t length = 0;
+	size_t start = i;
+
+	while (i < string.size() && string[i] >= '0' && string[i] <= '9')
+	{
+		length = length * 10 + (string[i] - '0');
+		i++;
+	}
+
+	if (i == start)
+	{
+		return false;
+	}
+
+	// a cut down name, just give back what is there
+	if (i + length > string.size())
+	{
+		name = string.substr(i);
+		i = string.size();
+		return false;
+	}
+
+	name = string.substr(i, length);
+	i += length;
+	return true;
+}
+
+bool manglerV3::demangle_modules(std::string_view string, size_t& i, std::vector<std::string_view>& modules)
+{
+	while (i < string.size())
+	{
+		if (string[i] >= '0' && string[i] <= '9')
+		{
+			std::string_view module;
+			bool complete = demangle_length_name(string, i, module);
+			modules.push_back(module);
+
+			if (!complete)
+			{
+				return false;
+			}
+		}
+		else if (string[i] == 'S')
+		{
+			i++;
+
+			size_t index = 0;
+			while (i < string.size() && string[i] >= '0' && string[i] <= '9')
+			{
+				index = index * 10 + (string[i] - '0');
+				i++;
+			}
+
+			if (i >= string.size() || string[i] != '_' || index >= modules.size())
+			{
+				return false;
+			}
+			i++;
+
+			modules.push_back(modules[index]);
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	return true;
+}
+
+bool manglerV3::demangle_types(std::string_view string, size_t& i, std::string& types)
+{
+	if (i < string.size() && string[i] == 'v')
+	{
+		i++;
+		return true;
+	}
+
+	while (i < string.size())
+	{
+		if (!types.empty())
+		{
+			types += ", ";
+		}
+
+		char code = string[i];
+		i++;
+
+		switch (code)
+		{
+			case 'a':
+			{
+				types += "i8";
+				break;
+			}
+			case 'h':
+			{
+				types += "u8";
+				break;
+			}
+			case 's':
+			{
+				types += "i16";
+				break;
+			}
+			case 't':
+			{
+				types += "u16";
+				break;
+			}
+			case 'i':
+			{
+				types += "i32";
+				break;
+			}
+			case 'j':
+			{
+				types += "u32";
+				break;
+			}
+			case 'l':
+			{
+				types += "i64";
+				break;
+			}
+			case 'm':
+			{
+				types += "u64";
+				break;
+			}
+			case 'f':
+			{
+				types += "f32";
+				break;
+			}
+			case 'd':
+			{
+				types += "f64";
+				break;
+			}
+			case 'v':
+			{
+				types += "void";
+				break;
+			}
+			case 'b':
+			{
+				types += "bool";
+				break;
+			}
+			case 'c':
+			{
+				types += "char";
+				break;
+			}
+			case 'u':
+			{
+				std::string_view type_name;
+				bool complete = demangle_length_name(string, i, type_name);
+				types += type_name;
+
+				if (!complete)
+				{
+					return false;
+				}
+				break;
+			}
+			default:
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+std::string manglerV3::join_modules(const std::vector<std::string_view>& modules)
+{
+	std::string pretty_string;
+
+	for (size_t i = 0; i < modules.size(); i++)
+	{
+		if (i != 0)
+		{
+			pretty_string += "::";
+		}
+		pretty_string += modules[i];
+	}
+
+	return pretty_string;
+}
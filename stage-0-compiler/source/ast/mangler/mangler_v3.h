@@ -0,0 +1,24 @@
+#pragma once
+
+#include "../ast.h"
+
+#include <string>
+#include <vector>
+
+// A compact version of ManglerV2, which gives shorter symbols in the object files.
+namespace manglerV3
+{
+	int mangle(int current_module_id, const ast::FunctionPrototype* proto);
+	int mangle(int current_module_id, const ast::CallExpr* expr);
+	int mangle(const ast::CallExpr* expr);
+	int mangle(const ast::FunctionPrototype* proto);
+	int mangle(int current_module_id, int function_id, const std::vector<types::Type>& function_args);
+	int add_module(int current_module_id, int other_module_id);
+	int add_mangled_name(int current_module_id, int mangled_name_id);
+	int mangle_using(const ast::BinaryExpr* scope_expr);
+	int extract_module(int function_id);
+
+	std::string pretty_modules(int module_id);
+	// turns a mangled name back into its source form, e.g. m1::m2::f(i32, f64)
+	std::string demangle(int mangled_id);
+}
@@ -1,16 +1,46 @@
 #include "module_manager.h"
 
-#include "mangler.h"
 #include "string_manager.h"
 
+#include <algorithm>
 #include <iostream>
-#include <list>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 namespace moduleManager
 {
+	class ExportedFunction
+	{
+	public:
+		int signature_id;
+		int function_id;
+	};
+
+	class ImportedFunction
+	{
+	public:
+		// the function a call resolves to, the current module is searched before the using modules
+		int function_id = -1;
+		// the using modules that export a function with the signature
+		std::vector<int> using_modules;
+	};
+
+	// The module dependency graph as adjacency lists, the modules are given a dense index,
+	// and there is an edge from each module to every module it uses.
+	class ModuleGraph
+	{
+	public:
+		// index -> module name
+		std::vector<int> modules;
+		// module name -> index
+		std::unordered_map<int, int> indices;
+		// index -> the modules it uses
+		std::vector<std::vector<int>> uses;
+		// index -> the modules that use it
+		std::vector<std::vector<int>> used_by;
+	};
+
 	// filename -> module name
 	static std::unordered_map<int, int> file_modules;
 	// filename -> ast bodyexpr
@@ -21,13 +51,20 @@ namespace moduleManager
 	static std::unordered_map<int, std::unordered_set<int>> file_usings;
 	// module -> usings
 	static std::unordered_map<int, std::unordered_set<int>> module_usings;
+	// the modules in the order they were added
+	static std::vector<int> module_list;
 	// module name -> exported functions
-	static std::unordered_map<int, std::unordered_set<int>> exported_functions;
-
-	std::unordered_set<int> find_using_modules(int module_id);
-	std::list<int> get_module_order();
-	std::vector<std::pair<int, int>> get_circular_dependencies();
-	void handle_circular_dependencies(std::unordered_set<int> circular_dependencies);
+	static std::unordered_map<int, std::vector<ExportedFunction>> exported_functions;
+	// function id -> symbol
+	static std::unordered_map<int, FunctionSymbol> function_symbols;
+	// filename -> function signature -> imported function
+	static std::unordered_map<int, std::unordered_map<int, ImportedFunction>> file_imports;
+
+	ModuleGraph build_module_graph();
+	bool sort_modules(const ModuleGraph& graph, std::vector<int>& order, std::vector<int>& levels);
+	std::vector<int> get_module_order();
+	std::vector<std::pair<int, int>> get_circular_dependencies(const ModuleGraph& graph);
+	void handle_circular_dependencies(const ModuleGraph& graph);
 	void log_error(const std::string& str);
 }
 
@@ -55,6 +92,7 @@ void moduleManager::add_module(int filename, int module_id, std::unordered_set<i
 	if (exported_functions.find(module_id) == exported_functions.end())
 	{
 		exported_functions[module_id] = {};
+		module_list.push_back(module_id);
 	}
 }
 
@@ -67,16 +105,11 @@ bool moduleManager::check_modules()
 
 		for (auto& v : file_usings.at(filename))
 		{
-			auto f = std::find_if(
-				file_modules.begin(),
-				file_modules.end(),
-				[&](const std::pair<int, int>& p) { return p.second == v; });
-
-			if (f == file_modules.end())
+			if (module_contents.find(v) == module_contents.end())
 			{
 				log_error(
-					"Using Module '" + stringManager::get_string(v) +
-					"' does not exist (in file: " + stringManager::get_string(filename) + ")");
+					"Using Module '" + std::string{stringManager::get_string(v)} +
+					"' does not exist (in file: " + std::string{stringManager::get_string(filename)} + ")");
 				return false;
 			}
 		}
@@ -96,112 +129,122 @@ bool moduleManager::is_module_available(int filename, int module_id)
 		return true;
 	}
 
-	for (auto& m : file_usings.at(filename))
+	const std::unordered_set<int>& usings = file_usings.at(filename);
+	return usings.find(module_id) != usings.end();
+}
+
+void moduleManager::add_function_symbol(
+	int filename,
+	ast::BodyExpr* body,
+	ast::FunctionPrototype* proto,
+	int function_id)
+{
+	// the top level functions are added again when their body is checked, so keep the exported flag
+	FunctionSymbol& symbol = function_symbols[function_id];
+	symbol.function_id = function_id;
+	symbol.module_id = file_modules.at(filename);
+	symbol.name_id = proto->unmangled_name_id;
+	symbol.parameter_types = proto->types;
+	symbol.filename = filename;
+	symbol.body = body;
+	symbol.prototype = proto;
+}
+
+void moduleManager::add_exported_function(int function_id, int signature_id)
+{
+	FunctionSymbol& symbol = function_symbols.at(function_id);
+	symbol.is_exported = true;
+	exported_functions.at(symbol.module_id).push_back(ExportedFunction{signature_id, function_id});
+}
+
+const moduleManager::FunctionSymbol* moduleManager::find_function_symbol(int function_id)
+{
+	auto f = function_symbols.find(function_id);
+	if (f == function_symbols.end())
 	{
-		if (m == module_id)
-		{
-			return true;
-		}
+		return nullptr;
 	}
 
-	return false;
+	return &f->second;
 }
 
-int moduleManager::find_function(int filename, int name_id, bool is_mangled)
+void moduleManager::build_import_index()
 {
-	std::unordered_set<int>& exported_functions = get_exported_functions(filename);
-	int module_id = get_module(filename);
+	file_imports.clear();
 
-	if (is_mangled)
+	for (auto& p : file_modules)
 	{
+		int filename = p.first;
+		std::unordered_map<int, ImportedFunction>& imports = file_imports[filename];
+
 		// check current module
-		for (auto& f : exported_functions)
+		for (auto& f : exported_functions.at(p.second))
 		{
-			if (f == name_id)
-			{
-				return f;
-			}
+			imports[f.signature_id].function_id = f.function_id;
 		}
 
 		// check using modules
 		for (auto& m : file_usings.at(filename))
 		{
-			std::unordered_set<int>& funcs = moduleManager::exported_functions.at(m);
-
-			// check module funtions
-			for (auto& f : funcs)
+			for (auto& f : exported_functions.at(m))
 			{
-				if (f == name_id)
+				ImportedFunction& imported = imports[f.signature_id];
+				if (imported.function_id == -1)
 				{
-					return f;
+					imported.function_id = f.function_id;
 				}
+				imported.using_modules.push_back(m);
 			}
 		}
 	}
+}
+
+int moduleManager::find_function(int filename, int name_id, bool is_mangled)
+{
+	if (is_mangled)
+	{
+		// the name includes the module, so check the module is the current module or a using module
+		const FunctionSymbol* symbol = find_function_symbol(name_id);
+		if (symbol != nullptr && symbol->is_exported && is_module_available(filename, symbol->module_id))
+		{
+			return name_id;
+		}
+	}
 	else
 	{
+		auto imports = file_imports.find(filename);
+		if (imports == file_imports.end())
 		{
-			// check current module
-			int mangled_id = mangler::add_mangled_name(module_id, name_id);
-			for (auto& f : exported_functions)
-			{
-				if (f == mangled_id)
-				{
-					return f;
-				}
-			}
+			return -1;
 		}
 
-		// check using modules
-		for (auto& m : file_usings.at(filename))
+		auto f = imports->second.find(name_id);
+		if (f != imports->second.end())
 		{
-			std::unordered_set<int>& funcs = moduleManager::exported_functions.at(m);
-
-			int mangled_id = mangler::add_mangled_name(m, name_id);
-
-			// check module funtions
-			for (auto& f : funcs)
-			{
-				if (f == mangled_id)
-				{
-					return f;
-				}
-			}
+			return f->second.function_id;
 		}
 	}
 
 	return -1;
 }
 
-std::vector<int> moduleManager::get_matching_function_locations(int filename, int name_id)
+const std::vector<int>& moduleManager::get_matching_function_locations(int filename, int name_id)
 {
-	std::vector<int> modules;
+	static const std::vector<int> no_modules;
 
-	// check using modules
-	for (auto& m : file_usings.at(filename))
+	auto imports = file_imports.find(filename);
+	if (imports == file_imports.end())
 	{
-		std::unordered_set<int>& funcs = exported_functions.at(m);
-
-		int mangled_id = mangler::add_mangled_name(m, name_id);
-
-		// check module funtions
-		for (auto& f : funcs)
-		{
-			if (f == mangled_id)
-			{
-				modules.push_back(m);
-				break;
-			}
-		}
+		return no_modules;
 	}
 
-	return modules;
-}
+	auto f = imports->second.find(name_id);
+	if (f == imports->second.end())
+	{
+		return no_modules;
+	}
 
-std::unordered_set<int>& moduleManager::get_exported_functions(int filename)
-{
-	int module_id = file_modules.at(filename);
-	return exported_functions.at(module_id);
+	return f->second.using_modules;
 }
 
 int moduleManager::get_module(int filename)
@@ -214,150 +257,206 @@ ast::BodyExpr* moduleManager::get_ast(int filename)
 	return ast_files.at(filename).get();
 }
 
-std::unordered_set<int> moduleManager::find_using_modules(int module_id)
+moduleManager::ModuleGraph moduleManager::build_module_graph()
 {
-	std::unordered_set<int> modules;
-	for (auto& p : module_usings)
+	ModuleGraph graph;
+	graph.modules = module_list;
+	graph.uses.resize(graph.modules.size());
+	graph.used_by.resize(graph.modules.size());
+
+	for (int i = 0; i < graph.modules.size(); i++)
 	{
-		if (p.second.find(module_id) != p.second.end())
+		graph.indices[graph.modules[i]] = i;
+	}
+
+	for (int i = 0; i < graph.modules.size(); i++)
+	{
+		for (auto& m : module_usings.at(graph.modules[i]))
 		{
-			modules.insert(p.first);
+			// the using modules have already been checked to exist
+			auto f = graph.indices.find(m);
+			if (f == graph.indices.end())
+			{
+				continue;
+			}
+
+			graph.uses[i].push_back(f->second);
+			graph.used_by[f->second].push_back(i);
 		}
 	}
-	return modules;
+
+	return graph;
 }
 
-std::list<int> moduleManager::get_module_order()
+bool moduleManager::sort_modules(const ModuleGraph& graph, std::vector<int>& order, std::vector<int>& levels)
 {
-	// do a topological sort on the modules
+	// do a topological sort on the modules, using Kahn's algorithm
 	// from:
 	//     https://en.wikipedia.org/wiki/Topological_sorting#Algorithms
-	//     https://www.techiedelight.com/kahn-topological-sort-algorithm/
+	// each module comes after the modules it uses, and the level of a module is one more than the highest level
+	// of the modules it uses, so the modules on the same level don't depend on each other
+
+	size_t module_count = graph.modules.size();
+
+	// the number of modules each module uses, that have not been added to the order yet
+	std::vector<size_t> indegree(module_count);
 
-	// list thta contains the topological order
-	std::list<int> L;
-	// set of all nodes without an incoming node
-	std::unordered_set<int> S;
-	std::unordered_map<int, int> indegree;
+	order.clear();
+	order.reserve(module_count);
+	levels.assign(module_count, 0);
 
-	for (auto& p : module_usings)
+	for (int i = 0; i < module_count; i++)
 	{
-		// set the indegree for the module
-		indegree[p.first] = p.second.size();
+		indegree[i] = graph.uses[i].size();
 
-		if (p.second.size() == 0)
+		if (indegree[i] == 0)
 		{
-			// add nodes with no incoming node to S
-			S.insert(p.first);
+			order.push_back(i);
 		}
 	}
 
-	while (S.size() > 0)
+	// the order is also the queue of modules with no remaining incoming edges
+	for (size_t next = 0; next < order.size(); next++)
 	{
-		// get the next node
-		int node = *S.begin();
-		// remove the node
-		S.erase(node);
+		int node = order[next];
 
-		// add node to tail of  L
-		L.push_back(node);
-
-		// for (auto& m : module_usings.at(node))
-		for (auto& m : find_using_modules(node))
+		for (auto& m : graph.used_by[node])
 		{
-			// remove edge from node -> m from graph
-			indegree[m] = indegree[m] - 1;
+			levels[m] = std::max(levels[m], levels[node] + 1);
 
-			// if m has no other incoming edges, insert m into S
+			// if m has no other incoming edges, add it to the order
+			indegree[m]--;
 			if (indegree[m] == 0)
 			{
-				S.insert(m);
+				order.push_back(m);
 			}
 		}
 	}
 
-	// if a graph has edges, then the graph has at least one cycle
-	std::unordered_set<int> circular_dependencies;
-	for (auto& p : indegree)
+	// if any module was not added, then the graph has at least one cycle
+	return order.size() == module_count;
+}
+
+std::vector<int> moduleManager::get_module_order()
+{
+	ModuleGraph graph = build_module_graph();
+
+	std::vector<int> order;
+	std::vector<int> levels;
+	if (!sort_modules(graph, order, levels))
 	{
-		if (p.second > 0)
-		{
-			circular_dependencies.insert(p.first);
-		}
+		handle_circular_dependencies(graph);
+		return {};
 	}
 
-	if (circular_dependencies.size() > 0)
+	std::vector<int> modules;
+	modules.reserve(order.size());
+	for (auto& index : order)
+	{
+		modules.push_back(graph.modules[index]);
+	}
+
+	return modules;
+}
+
+std::vector<std::vector<int>> moduleManager::get_module_levels()
+{
+	ModuleGraph graph = build_module_graph();
+
+	std::vector<int> order;
+	std::vector<int> levels;
+	if (!sort_modules(graph, order, levels))
 	{
-		handle_circular_dependencies(circular_dependencies);
 		return {};
 	}
 
-	return L;
+	std::vector<std::vector<int>> modules;
+	for (auto& index : order)
+	{
+		if (levels[index] >= modules.size())
+		{
+			modules.resize(levels[index] + 1);
+		}
+		modules[levels[index]].push_back(graph.modules[index]);
+	}
+
+	return modules;
 }
 
-std::vector<std::pair<int, int>> moduleManager::get_circular_dependencies()
+std::vector<std::pair<int, int>> moduleManager::get_circular_dependencies(const ModuleGraph& graph)
 {
+	enum class VisitState : uint8_t
+	{
+		NotVisited,
+		OnPath,
+		Finished,
+	};
+
 	std::vector<std::pair<int, int>> circular_dependencies;
 
-	// find cycles in dag:
+	// find cycles in the graph with a depth first search, any edge back to a module on the current path is a cycle:
 	// https://stackoverflow.com/questions/261573/best-algorithm-for-detecting-cycles-in-a-directed-graph
-	std::unordered_set<int> discovered;
-	std::unordered_set<int> finished;
+	std::vector<VisitState> states(graph.modules.size(), VisitState::NotVisited);
+
+	// the current path, with the index of the next edge to follow from each module
+	std::vector<std::pair<int, size_t>> path;
 
-	std::function<std::vector<std::pair<int, int>>(int)> dfs_visit;
-	dfs_visit = [&](int u)
+	for (int root = 0; root < graph.modules.size(); root++)
 	{
-		std::vector<std::pair<int, int>> found_cycles;
+		if (states[root] != VisitState::NotVisited)
+		{
+			continue;
+		}
 
-		discovered.insert(u);
+		states[root] = VisitState::OnPath;
+		path.push_back({root, 0});
 
-		for (auto& v : find_using_modules(u))
+		while (path.size() > 0)
 		{
-			if (discovered.find(v) != discovered.end())
+			int u = path.back().first;
+			size_t edge = path.back().second;
+
+			if (edge == graph.used_by[u].size())
 			{
-				found_cycles.push_back({ u, v });
+				states[u] = VisitState::Finished;
+				path.pop_back();
 				continue;
 			}
 
-			if (finished.find(v) == finished.end())
+			path.back().second++;
+
+			int v = graph.used_by[u][edge];
+			if (states[v] == VisitState::OnPath)
+			{
+				circular_dependencies.push_back({graph.modules[u], graph.modules[v]});
+			}
+			else if (states[v] == VisitState::NotVisited)
 			{
-				auto r = dfs_visit(v);
-				found_cycles.insert(found_cycles.end(), r.begin(), r.end());
+				states[v] = VisitState::OnPath;
+				path.push_back({v, 0});
 			}
 		}
-
-		discovered.erase(u);
-		finished.insert(u);
-
-		return found_cycles;
-	};
-
-	for (auto& p : module_contents)
-	{
-		int u = p.first;
-		auto r = dfs_visit(u);
-		circular_dependencies.insert(circular_dependencies.end(), r.begin(), r.end());
 	}
 
 	return circular_dependencies;
 }
 
-void moduleManager::handle_circular_dependencies(std::unordered_set<int> circular_dependencies)
+void moduleManager::handle_circular_dependencies(const ModuleGraph& graph)
 {
 	log_error("Module Graph has circular dependencies:");
 
-	auto r = get_circular_dependencies();
+	auto r = get_circular_dependencies(graph);
 	for (auto p : r)
 	{
 		log_error(
-			"\tIn module '" + stringManager::get_string(p.first) + "': requiring '" +
-			stringManager::get_string(p.second) + "' creates a cycle.");
+			"\tIn module '" + std::string{stringManager::get_string(p.first)} + "': requiring '" +
+			std::string{stringManager::get_string(p.second)} + "' creates a cycle.");
 	}
 }
 
 std::vector<int> moduleManager::get_build_files_order()
 {
-	std::list<int> module_order = get_module_order();
+	std::vector<int> module_order = get_module_order();
 
 	std::vector<int> files;
 	for (auto& m : module_order)
@@ -371,19 +470,20 @@ std::vector<int> moduleManager::get_build_files_order()
 
 ast::BodyExpr* moduleManager::find_body(int function_id)
 {
-	int module_name = mangler::extract_module(function_id);
-
-	for (auto& file : module_contents.at(module_name))
+	const FunctionSymbol* symbol = find_function_symbol(function_id);
+	if (symbol == nullptr)
 	{
-		ast::BodyExpr* body = get_ast(file);
-
-		if (body->function_prototypes.find(function_id) != body->function_prototypes.end())
-		{
-			return body;
-		}
+		return nullptr;
 	}
 
-	return nullptr;
+	return symbol->body;
+}
+
+void moduleManager::clear_asts()
+{
+	// the symbols point into the asts
+	function_symbols.clear();
+	ast_files.clear();
 }
 
 void moduleManager::log_error(const std::string& str)
@@ -9,16 +9,42 @@
 
 namespace moduleManager
 {
+	// The record behind a mangled function id, so nothing has to be recovered from the mangled name
+	class FunctionSymbol
+	{
+	public:
+		int function_id = -1;
+		int module_id = -1;
+		// the name of the function, without its module or parameters
+		int name_id = -1;
+		std::vector<types::Type> parameter_types;
+		int filename = -1;
+		// the body the function is declared in
+		ast::BodyExpr* body = nullptr;
+		ast::FunctionPrototype* prototype = nullptr;
+		bool is_exported = false;
+	};
+
 	void add_ast(int filename, ptr_type<ast::BodyExpr> ast_body);
 	int get_file_as_module(const std::string& file_name);
 	void add_module(int filename, int module_id, std::unordered_set<int>& usings);
 	bool check_modules();
 	bool is_module_available(int filename, int module_id);
+	void add_function_symbol(int filename, ast::BodyExpr* body, ast::FunctionPrototype* proto, int function_id);
+	// the function must already have a symbol, signature_id is the mangled name of the function without its module
+	void add_exported_function(int function_id, int signature_id);
+	// returns nullptr if the id is not a function
+	const FunctionSymbol* find_function_symbol(int function_id);
+	// builds the functions each file can call, must be called once every file has exported its functions
+	void build_import_index();
 	int find_function(int filename, int name_id, bool is_mangled);
-	std::vector<int> get_matching_function_locations(int filename, int name_id);
-	std::unordered_set<int>& get_exported_functions(int filename);
+	const std::vector<int>& get_matching_function_locations(int filename, int name_id);
 	int get_module(int filename);
 	ast::BodyExpr* get_ast(int filename);
 	std::vector<int> get_build_files_order();
+	// the modules grouped by dependency level, each module only uses modules from lower levels,
+	// returns an empty list if the modules have a cycle
+	std::vector<std::vector<int>> get_module_levels();
 	ast::BodyExpr* find_body(int function_id);
+	void clear_asts();
 }
@@ -2,263 +2,6 @@
 
 namespace operators
 {
-	bool is_first_char_valid(char c)
-	{
-		if (c == '=')
-		{
-			return true;
-		}
-		else if (c == '+')
-		{
-			return true;
-		}
-		else if (c == '-')
-		{
-			return true;
-		}
-		else if (c == '*')
-		{
-			return true;
-		}
-		else if (c == '/')
-		{
-			return true;
-		}
-		else if (c == '%')
-		{
-			return true;
-		}
-		else if (c == '<')
-		{
-			return true;
-		}
-		else if (c == '>')
-		{
-			return true;
-		}
-		else if (c == '!')
-		{
-			return true;
-		}
-		else if (c == '&')
-		{
-			return true;
-		}
-		else if (c == '|')
-		{
-			return true;
-		}
-		else if (c == '^')
-		{
-			return true;
-		}
-		else if (c == ':')
-		{
-			return true;
-		}
-		return false;
-	}
-
-	bool is_second_char_valid(char c)
-	{
-		if (c == '=')
-		{
-			return true;
-		}
-		else if (c == '&')
-		{
-			return true;
-		}
-		else if (c == '|')
-		{
-			return true;
-		}
-		else if (c == '<')
-		{
-			return true;
-		}
-		else if (c == '>')
-		{
-			return true;
-		}
-		else if (c == ':')
-		{
-			return true;
-		}
-		return false;
-	}
-
-	BinaryOp is_binary_op(const std::string& str)
-	{
-		if (str.length() == 1)
-		{
-			if (is_first_char_valid(str[0]))
-			{
-				char c = str[0];
-
-				if (c == '=')
-				{
-					return BinaryOp::Assignment;
-				}
-				else if (c == '+')
-				{
-					return BinaryOp::Addition;
-				}
-				else if (c == '-')
-				{
-					return BinaryOp::Subtraction;
-				}
-				else if (c == '*')
-				{
-					return BinaryOp::Multiplication;
-				}
-				else if (c == '/')
-				{
-					return BinaryOp::Division;
-				}
-				else if (c == '%')
-				{
-					return BinaryOp::Modulo;
-				}
-				else if (c == '<')
-				{
-					return BinaryOp::LessThan;
-				}
-				else if (c == '>')
-				{
-					return BinaryOp::GreaterThan;
-				}
-				else if (c == '&')
-				{
-					return BinaryOp::BitwiseAnd;
-				}
-				else if (c == '|')
-				{
-					return BinaryOp::BitwiseOr;
-				}
-				else if (c == '^')
-				{
-					return BinaryOp::BitwiseXor;
-				}
-			}
-		}
-		else if (str.length() == 2)
-		{
-			char c1 = str[0];
-			char c2 = str[1];
-
-			if (c2 == '=')
-			{
-				if (c1 == '<')
-				{
-					return BinaryOp::LessThanEqual;
-				}
-				else if (c1 == '>')
-				{
-					return BinaryOp::GreaterThanEqual;
-				}
-				else if (c1 == '=')
-				{
-					return BinaryOp::EqualTo;
-				}
-				else if (c1 == '!')
-				{
-					return BinaryOp::NotEqualTo;
-				}
-				else if (c1 == '+')
-				{
-					return BinaryOp::AssignmentAddition;
-				}
-				else if (c1 == '-')
-				{
-					return BinaryOp::AssignmentSubtraction;
-				}
-				else if (c1 == '*')
-				{
-					return BinaryOp::AssignmentMultiplication;
-				}
-				else if (c1 == '%')
-				{
-					return BinaryOp::AssignmentModulo;
-				}
-				else if (c1 == '/')
-				{
-					return BinaryOp::AssignmentDivision;
-				}
-				else if (c1 == '&')
-				{
-					return BinaryOp::AssignmentBitwiseAnd;
-				}
-				else if (c1 == '|')
-				{
-					return BinaryOp::AssignmentBitwiseOr;
-				}
-				else if (c1 == '^')
-				{
-					return BinaryOp::AssignmentBitwiseXor;
-				}
-			}
-			else if (c2 == '&')
-			{
-				if (c1 == '&')
-				{
-					return BinaryOp::BooleanAnd;
-				}
-			}
-			else if (c2 == '|')
-			{
-				if (c1 == '|')
-				{
-					return BinaryOp::BooleanOr;
-				}
-			}
-			else if (c2 == '<')
-			{
-				if (c1 == '<')
-				{
-					return BinaryOp::BitwiseShiftLeft;
-				}
-			}
-			else if (c2 == '>')
-			{
-				if (c1 == '>')
-				{
-					return BinaryOp::BitwiseShiftRight;
-				}
-			}
-			else if (c2 == ':')
-			{
-				if (c1 == ':')
-				{
-					return BinaryOp::ModuleScope;
-				}
-			}
-		}
-
-		return BinaryOp::None;
-	}
-
-	UnaryOp is_unary_op(char c)
-	{
-		if (c == '+')
-		{
-			return UnaryOp::Plus;
-		}
-		else if (c == '-')
-		{
-			return UnaryOp::Minus;
-		}
-		else if (c == '!')
-		{
-			return UnaryOp::BooleanNot;
-		}
-		else if (c == '~')
-		{
-			return UnaryOp::BitwiseNot;
-		}
-		return UnaryOp::None;
-	}
-
 	bool is_binary_comparision(BinaryOp op)
 	{
 		switch (op)
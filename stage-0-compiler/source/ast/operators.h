@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 #include "types.h"
@@ -49,10 +52,174 @@ namespace operators
 		BitwiseNot,
 	};
 
-	bool is_first_char_valid(char c);
-	bool is_second_char_valid(char c);
-	BinaryOp is_binary_op(const std::string& str);
-	UnaryOp is_unary_op(char c);
+	inline constexpr size_t BinaryOpCount = static_cast<size_t>(BinaryOp::ModuleScope) + 1;
+
+	// The lookup tables used by the lexer and parser, they are all generated at compile time.
+	namespace tables
+	{
+		// the characters that can be the second character of a two character operator, mapped to a column in the
+		// two character operator table, 0 means not valid
+		constexpr std::array<uint8_t, 256> make_second_char_columns()
+		{
+			std::array<uint8_t, 256> table{};
+			table['='] = 1;
+			table['&'] = 2;
+			table['|'] = 3;
+			table['<'] = 4;
+			table['>'] = 5;
+			table[':'] = 6;
+			return table;
+		}
+
+		inline constexpr size_t SecondCharColumns = 7;
+		inline constexpr std::array<uint8_t, 256> second_char_columns = make_second_char_columns();
+
+		constexpr size_t two_char_index(char c1, char c2)
+		{
+			return static_cast<unsigned char>(c1) * SecondCharColumns + second_char_columns[static_cast<unsigned char>(c2)];
+		}
+
+		constexpr std::array<BinaryOp, 256> make_single_char_ops()
+		{
+			std::array<BinaryOp, 256> table{};
+			table['='] = BinaryOp::Assignment;
+			table['+'] = BinaryOp::Addition;
+			table['-'] = BinaryOp::Subtraction;
+			table['*'] = BinaryOp::Multiplication;
+			table['/'] = BinaryOp::Division;
+			table['%'] = BinaryOp::Modulo;
+			table['<'] = BinaryOp::LessThan;
+			table['>'] = BinaryOp::GreaterThan;
+			table['&'] = BinaryOp::BitwiseAnd;
+			table['|'] = BinaryOp::BitwiseOr;
+			table['^'] = BinaryOp::BitwiseXor;
+			return table;
+		}
+
+		constexpr std::array<BinaryOp, 256 * SecondCharColumns> make_two_char_ops()
+		{
+			std::array<BinaryOp, 256 * SecondCharColumns> table{};
+			table[two_char_index('<', '=')] = BinaryOp::LessThanEqual;
+			table[two_char_index('>', '=')] = BinaryOp::GreaterThanEqual;
+			table[two_char_index('=', '=')] = BinaryOp::EqualTo;
+			table[two_char_index('!', '=')] = BinaryOp::NotEqualTo;
+			table[two_char_index('+', '=')] = BinaryOp::AssignmentAddition;
+			table[two_char_index('-', '=')] = BinaryOp::AssignmentSubtraction;
+			table[two_char_index('*', '=')] = BinaryOp::AssignmentMultiplication;
+			table[two_char_index('%', '=')] = BinaryOp::AssignmentModulo;
+			table[two_char_index('/', '=')] = BinaryOp::AssignmentDivision;
+			table[two_char_index('&', '=')] = BinaryOp::AssignmentBitwiseAnd;
+			table[two_char_index('|', '=')] = BinaryOp::AssignmentBitwiseOr;
+			table[two_char_index('^', '=')] = BinaryOp::AssignmentBitwiseXor;
+			table[two_char_index('&', '&')] = BinaryOp::BooleanAnd;
+			table[two_char_index('|', '|')] = BinaryOp::BooleanOr;
+			table[two_char_index('<', '<')] = BinaryOp::BitwiseShiftLeft;
+			table[two_char_index('>', '>')] = BinaryOp::BitwiseShiftRight;
+			table[two_char_index(':', ':')] = BinaryOp::ModuleScope;
+			return table;
+		}
+
+		constexpr std::array<bool, 256> make_first_chars()
+		{
+			std::array<bool, 256> table{};
+			for (char c : {'=', '+', '-', '*', '/', '%', '<', '>', '!', '&', '|', '^', ':'})
+			{
+				table[static_cast<unsigned char>(c)] = true;
+			}
+			return table;
+		}
+
+		constexpr std::array<UnaryOp, 256> make_unary_ops()
+		{
+			std::array<UnaryOp, 256> table{};
+			table['+'] = UnaryOp::Plus;
+			table['-'] = UnaryOp::Minus;
+			table['!'] = UnaryOp::BooleanNot;
+			table['~'] = UnaryOp::BitwiseNot;
+			return table;
+		}
+
+		// clang-format off
+		// the operator precedences, higher binds tighter, same binds to the left
+		constexpr std::array<int, BinaryOpCount> make_precedences()
+		{
+			std::array<int, BinaryOpCount> table{};
+			for (int& precedence : table)
+			{
+				precedence = -1;
+			}
+			table[static_cast<size_t>(BinaryOp::Assignment)]               =  10;
+			table[static_cast<size_t>(BinaryOp::AssignmentAddition)]       =  10;
+			table[static_cast<size_t>(BinaryOp::AssignmentSubtraction)]    =  10;
+			table[static_cast<size_t>(BinaryOp::AssignmentMultiplication)] =  10;
+			table[static_cast<size_t>(BinaryOp::AssignmentModulo)]         =  10;
+			table[static_cast<size_t>(BinaryOp::AssignmentDivision)]       =  10;
+			table[static_cast<size_t>(BinaryOp::AssignmentBitwiseAnd)]     =  10;
+			table[static_cast<size_t>(BinaryOp::AssignmentBitwiseOr)]      =  10;
+			table[static_cast<size_t>(BinaryOp::AssignmentBitwiseXor)]     =  10;
+			table[static_cast<size_t>(BinaryOp::BooleanOr)]                =  20;
+			table[static_cast<size_t>(BinaryOp::BooleanAnd)]               =  30;
+			table[static_cast<size_t>(BinaryOp::BitwiseOr)]                =  40;
+			table[static_cast<size_t>(BinaryOp::BitwiseXor)]               =  50;
+			table[static_cast<size_t>(BinaryOp::BitwiseAnd)]               =  60;
+			table[static_cast<size_t>(BinaryOp::EqualTo)]                  =  70;
+			table[static_cast<size_t>(BinaryOp::NotEqualTo)]               =  80;
+			table[static_cast<size_t>(BinaryOp::LessThan)]                 = 100;
+			table[static_cast<size_t>(BinaryOp::LessThanEqual)]            = 100;
+			table[static_cast<size_t>(BinaryOp::GreaterThan)]              = 100;
+			table[static_cast<size_t>(BinaryOp::GreaterThanEqual)]         = 100;
+			table[static_cast<size_t>(BinaryOp::BitwiseShiftLeft)]         = 110;
+			table[static_cast<size_t>(BinaryOp::BitwiseShiftRight)]        = 110;
+			table[static_cast<size_t>(BinaryOp::Addition)]                 = 120;
+			table[static_cast<size_t>(BinaryOp::Subtraction)]              = 120;
+			table[static_cast<size_t>(BinaryOp::Multiplication)]           = 140;
+			table[static_cast<size_t>(BinaryOp::Division)]                 = 140;
+			table[static_cast<size_t>(BinaryOp::Modulo)]                   = 140;
+			table[static_cast<size_t>(BinaryOp::ModuleScope)]              = 200;
+			return table;
+		}
+		// clang-format on
+
+		inline constexpr std::array<bool, 256> first_chars = make_first_chars();
+		inline constexpr std::array<BinaryOp, 256> single_char_ops = make_single_char_ops();
+		inline constexpr std::array<BinaryOp, 256 * SecondCharColumns> two_char_ops = make_two_char_ops();
+		inline constexpr std::array<UnaryOp, 256> unary_ops = make_unary_ops();
+		inline constexpr std::array<int, BinaryOpCount> precedences = make_precedences();
+	}
+
+	constexpr bool is_first_char_valid(char c)
+	{
+		return tables::first_chars[static_cast<unsigned char>(c)];
+	}
+
+	constexpr bool is_second_char_valid(char c)
+	{
+		return tables::second_char_columns[static_cast<unsigned char>(c)] != 0;
+	}
+
+	// the single character operator, e.g. '+'
+	constexpr BinaryOp get_binary_op(char c)
+	{
+		return tables::single_char_ops[static_cast<unsigned char>(c)];
+	}
+
+	// the two character operator, e.g. '+=', the second character must be valid
+	constexpr BinaryOp get_binary_op(char c1, char c2)
+	{
+		return tables::two_char_ops[tables::two_char_index(c1, c2)];
+	}
+
+	constexpr UnaryOp is_unary_op(char c)
+	{
+		return tables::unary_ops[static_cast<unsigned char>(c)];
+	}
+
+	// the precedence of the binary operator, or -1 if it is not a binary operator
+	constexpr int get_precedence(BinaryOp op)
+	{
+		return tables::precedences[static_cast<size_t>(op)];
+	}
+
 	bool is_binary_comparision(BinaryOp op);
 	bool is_boolean_operator(BinaryOp op);
 	bool is_boolean_operator(UnaryOp op);
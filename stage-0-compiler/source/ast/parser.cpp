@@ -3,51 +3,24 @@
 #include "../utils.h"
 #include "mangler.h"
 #include "module_manager.h"
+#include "source_manager.h"
 #include "string_manager.h"
+#include "visitor.h"
 
+#include <iomanip>
 #include <iostream>
 
 namespace parser
 {
-	// clang-format off
-	// the operator precedences, higher binds tighter, same binds to the left
-	const std::unordered_map<operators::BinaryOp, int> Parser::binop_precedence = {
-		{operators::BinaryOp::Assignment,                10},
-		{operators::BinaryOp::AssignmentAddition,        10},
-		{operators::BinaryOp::AssignmentSubtraction,     10},
-		{operators::BinaryOp::AssignmentMultiplication,  10},
-		{operators::BinaryOp::AssignmentModulo,          10},
-		{operators::BinaryOp::AssignmentDivision,        10},
-		{operators::BinaryOp::AssignmentBitwiseAnd,      10},
-		{operators::BinaryOp::AssignmentBitwiseOr,       10},
-		{operators::BinaryOp::AssignmentBitwiseXor,      10},
-		{operators::BinaryOp::BooleanOr,                 20},
-		{operators::BinaryOp::BooleanAnd,                30},
-		{operators::BinaryOp::BitwiseOr,                 40},
-		{operators::BinaryOp::BitwiseXor,                50},
-		{operators::BinaryOp::BitwiseAnd,                60},
-		{operators::BinaryOp::EqualTo,                   70},
-		{operators::BinaryOp::NotEqualTo,                80},
-		{operators::BinaryOp::LessThan,                 100},
-		{operators::BinaryOp::LessThanEqual,            100},
-		{operators::BinaryOp::GreaterThan,              100},
-		{operators::BinaryOp::GreaterThanEqual,         100},
-		{operators::BinaryOp::BitwiseShiftLeft,         110},
-		{operators::BinaryOp::BitwiseShiftRight,        110},
-		{operators::BinaryOp::Addition,                 120},
-		{operators::BinaryOp::Subtraction,              120},
-		{operators::BinaryOp::Multiplication,           140},
-		{operators::BinaryOp::Division,                 140},
-		{operators::BinaryOp::Modulo,                   140},
-		{operators::BinaryOp::ModuleScope,              200},
-	};
-	// clang-format on
-
-	Parser::Parser(std::ifstream& input_file, const std::string& file_name) :
-		input_file(input_file),
+	Parser::Parser(const llvm::MemoryBuffer& input_buffer, const std::string& file_name) :
+		buffer_start(input_buffer.getBufferStart()),
+		buffer_end(input_buffer.getBufferEnd()),
+		lexer(buffer_start, buffer_end),
 		file_name(file_name)
 	{
 		filename_id = moduleManager::get_file_as_module(file_name);
+
+		tokens = lexer.tokenize();
 	}
 
 	ptr_type<ast::BaseExpr> Parser::parse_file()
@@ -76,341 +49,124 @@ namespace parser
 		return this->filename_id;
 	}
 
-	char Parser::get_char()
+	const LexedToken& Parser::current_token() const
 	{
-		char c = input_file.get();
-		if (c == '\n')
-		{
-			// reset the line
-			line_info.line = "";
-			// increment the line number
-			line_info.line_count++;
-			// reset line pos
-			line_info.line_pos = 0;
-		}
-		else if (c == '\r')
-		{
-			// ignore
-		}
-		else if (c == '\t')
-		{
-			// convert tab to space
-			line_info.line += ' ';
-			// increment line pos
-			line_info.line_pos++;
-		}
-		else
-		{
-			// add char to line
-			line_info.line += c;
-			// increment line pos
-			line_info.line_pos++;
-		}
-
-		return c;
+		return tokens[token_index];
 	}
 
-	char Parser::peek_char()
+	std::string_view Parser::token_text(const LexedToken& token) const
 	{
-		return input_file.peek();
+		return std::string_view{buffer_start + token.offset, token.length};
 	}
 
-	void Parser::skip_char()
+	char Parser::current_char() const
 	{
-		last_char = get_char();
-		line_info.line_pos_start = line_info.line_pos;
-		identifier_string = last_char;
-		curr_token = Token::None;
-	}
+		const LexedToken& token = current_token();
 
-	Token Parser::peek_next_token()
-	{
-		// store state
-		char last_c = last_char;
-		std::string id_str = identifier_string;
-		Token curr_tok = curr_token;
-		types::Type curr_ty = curr_type;
-		LineInfo line_inf = line_info;
-		int pos = this->input_file.tellg();
-
-		Token next_tok = get_next_token();
-
-		// restore state
-		last_char = last_c;
-		identifier_string = id_str;
-		curr_token = curr_tok;
-		curr_type = curr_ty;
-		line_info = line_inf;
-		this->input_file.seekg(pos);
-
-		return next_tok;
+		if (token.length == 0)
+		{
+			return std::char_traits<char>::eof();
+		}
+
+		// the last character of the current token
+		return buffer_start[token.offset + token.length - 1];
 	}
 
-	Token Parser::get_next_token()
+	types::Type Parser::current_type_name() const
 	{
-		identifier_string = "";
-		curr_token = Token::None;
-
-		last_char = get_char();
-		// skip whitespace
-		while (std::isspace(last_char))
+		if (curr_token != Token::VariableReference)
 		{
-			last_char = get_char();
+			return types::Type{types::TypeEnum::None};
 		}
 
-		line_info.line_pos_start = line_info.line_pos;
+		return types::is_valid_type(stringManager::get_string(current_token().identifier_id));
+	}
 
-		// identifier: [a-zA-Z_][a-zA-Z0-9_]*
-		if (std::isalpha(last_char) || last_char == '_')
+	sourceManager::SourceRange Parser::get_source_range(uint32_t start_offset) const
+	{
+		// the range ends at the last token that was eaten, unless that is before the start,
+		// then the expression is only the current token
+		uint32_t end_offset = 0;
+		if (token_index > 0)
 		{
-			identifier_string = last_char;
-			char next_char = peek_char();
-			while (std::isalnum(next_char) || next_char == '_')
-			{
-				last_char = get_char();
-				identifier_string += last_char;
-				next_char = peek_char();
-			}
-
-			if (identifier_string == "function")
-			{
-				curr_token = Token::FunctionDefinition;
-				return Token::FunctionDefinition;
-			}
-			else if (identifier_string == "extern")
-			{
-				curr_token = Token::ExternFunction;
-				return curr_token;
-			}
-			else if (identifier_string == "if")
-			{
-				curr_token = Token::IfStatement;
-				return curr_token;
-			}
-			else if (identifier_string == "else")
-			{
-				curr_token = Token::ElseStatement;
-				return curr_token;
-			}
-			else if (identifier_string == "var")
-			{
-				curr_token = Token::VariableDeclaration;
-				return curr_token;
-			}
-			else if (identifier_string == "for")
-			{
-				curr_token = Token::ForStatement;
-				return curr_token;
-			}
-			else if (identifier_string == "while")
-			{
-				curr_token = Token::WhileStatement;
-				return curr_token;
-			}
-			else if (identifier_string == "return")
-			{
-				curr_token = Token::ReturnStatement;
-				return curr_token;
-			}
-			else if (identifier_string == "continue")
-			{
-				curr_token = Token::ContinueStatement;
-				return curr_token;
-			}
-			else if (identifier_string == "break")
-			{
-				curr_token = Token::BreakStatement;
-				return curr_token;
-			}
-			else if (identifier_string == "module")
-			{
-				curr_token = Token::ModuleStatement;
-				return curr_token;
-			}
-			else if (identifier_string == "using")
-			{
-				curr_token = Token::UsingStatement;
-				return curr_token;
-			}
-			else if (this->identifier_string == "switch")
-			{
-				this->curr_token = Token::SwitchStatement;
-				return this->curr_token;
-			}
-			else if (this->identifier_string == "case")
-			{
-				this->curr_token = Token::CaseStatement;
-				return this->curr_token;
-			}
-			else if (this->identifier_string == "default")
-			{
-				this->curr_token = Token::DefaultStatement;
-				return this->curr_token;
-			}
-			else
-			{
-				// check if identifier is a bool
-				std::pair<bool, types::Type> res = types::check_type_string(identifier_string);
-				if (res.first && res.second.get_type_enum() == types::TypeEnum::Bool)
-				{
-					curr_type = res.second;
-					curr_token = Token::LiteralValue;
-					return curr_token;
-				}
-
-				curr_token = Token::VariableReference;
-				return Token::VariableReference;
-			}
+			const LexedToken& previous_token = tokens[token_index - 1];
+			end_offset = previous_token.offset + previous_token.length;
 		}
 
-		// literal:
-		//		int: [0-9][0-9]*((i|u)(8|16|32|64)?)?
-		//		float: ([0-9][0-9]*)[.]([0-9][0-9]*)(f(32|64)?)?
-		if (std::isdigit(last_char))
+		if (end_offset <= start_offset)
 		{
-			identifier_string = last_char;
-			char next_char = peek_char();
-			while (std::isdigit(next_char) || next_char == '.' || next_char == 'f' || next_char == 'i' ||
-				   next_char == 'u')
-			{
-				last_char = get_char();
-				identifier_string += last_char;
-				next_char = peek_char();
-			}
-
-			std::pair<bool, types::Type> res = types::check_type_string(identifier_string);
-
-			if (res.first)
-			{
-				curr_type = res.second;
-				curr_token = Token::LiteralValue;
-				return curr_token;
-			}
+			end_offset = current_token().offset + current_token().length;
 		}
 
-		// literal:
-		//		char: '.'
-		if (last_char == '\'')
-		{
-			identifier_string = last_char;
-			char next_char = get_char();
-			while (next_char != '\'' || identifier_string.back() == '\\')
-			{
-				last_char = next_char;
-				identifier_string += last_char;
-				next_char = get_char();
-			}
-
-			last_char = next_char;
-			identifier_string += last_char;
-
-			std::pair<bool, types::Type> res = types::check_type_string(identifier_string);
+		return sourceManager::SourceRange{filename_id, start_offset, end_offset};
+	}
 
-			if (res.first)
-			{
-				curr_type = res.second;
-				curr_token = Token::LiteralValue;
-				return curr_token;
-			}
-		}
+	ptr_type<ast::BaseExpr> Parser::with_source_range(ptr_type<ast::BaseExpr> expr, uint32_t start_offset) const
+	{
+		expr->set_source_range(get_source_range(start_offset));
+		return expr;
+	}
 
-		// end of file
-		if (last_char == std::ifstream::traits_type::eof())
-		{
-			curr_token = Token::EndOfFile;
-			return curr_token;
-		}
+	void Parser::split_next_token()
+	{
+		// splits the first character off of the next token, e.g. the '>' of a '>='
+		LexedToken first_char = tokens[next_token_index];
+		first_char.token = Token::AngleEnd;
+		first_char.binop = operators::BinaryOp::None;
+		first_char.length = 1;
 
-		// end of expression
-		if (last_char == ';')
-		{
-			curr_token = Token::EndOfExpression;
-			return curr_token;
-		}
+		relex_tokens(next_token_index, first_char.offset + 1);
 
-		// start of body
-		if (last_char == '{')
-		{
-			curr_token = Token::BodyStart;
-			return curr_token;
-		}
+		tokens.insert(tokens.begin() + next_token_index, first_char);
+	}
 
-		// end of body
-		if (last_char == '}')
-		{
-			curr_token = Token::BodyEnd;
-			return curr_token;
-		}
+	void Parser::relex_tokens(size_t token_index, uint32_t offset)
+	{
+		// lex from the offset until a new token starts at the same place as an old one, from then on they are the same
+		std::vector<LexedToken> relexed_tokens;
+		size_t old_index = token_index;
 
-		// paren start
-		if (last_char == '(')
-		{
-			curr_token = Token::ParenStart;
-			return curr_token;
-		}
+		lexer.seek(offset);
 
-		// paren end
-		if (last_char == ')')
+		while (true)
 		{
-			curr_token = Token::ParenEnd;
-			return curr_token;
-		}
+			LexedToken token = lexer.lex_token();
 
-		// binary operator
-		if (operators::is_first_char_valid(last_char))
-		{
-			std::string chars;
-			chars += last_char;
-			char next_char = peek_char();
-			if (operators::is_second_char_valid(next_char))
+			while (tokens[old_index].offset < token.offset)
 			{
-				chars += next_char;
+				old_index++;
 			}
 
-			if (operators::is_binary_op(chars) != operators::BinaryOp::None)
+			if (tokens[old_index].offset == token.offset)
 			{
-				if (chars.length() == 2)
-				{
-					last_char = get_char();
-				}
-				identifier_string = chars;
-				last_char = chars.back();
-				curr_token = Token::BinaryOperator;
-				return curr_token;
+				break;
 			}
-		}
 
-		// angle start
-		if (last_char == '<')
-		{
-			curr_token = Token::AngleStart;
-			return curr_token;
+			relexed_tokens.push_back(token);
 		}
 
-		// angle end
-		if (last_char == '>')
-		{
-			curr_token = Token::AngleEnd;
-			return curr_token;
-		}
+		tokens.erase(tokens.begin() + token_index, tokens.begin() + old_index);
+		tokens.insert(tokens.begin() + token_index, relexed_tokens.begin(), relexed_tokens.end());
+	}
 
-		// comma
-		if (last_char == ',')
-		{
-			curr_token = Token::Comma;
-			return curr_token;
-		}
+	Token Parser::peek_next_token()
+	{
+		return tokens[next_token_index].token;
+	}
 
-		if (last_char == '#')
+	Token Parser::get_next_token()
+	{
+		token_index = next_token_index;
+
+		// the last token is always the end of file, so never move past it
+		if (tokens[token_index].token != Token::EndOfFile)
 		{
-			curr_token = Token::Comment;
-			return curr_token;
+			next_token_index++;
 		}
 
-		// std::cout << "identifier " << identifier_string << " " << last_char << std::endl;
+		curr_token = tokens[token_index].token;
+		curr_type = tokens[token_index].literal.type;
 
-		// anything else
-		curr_token = Token::None;
 		return curr_token;
 	}
 
@@ -433,6 +189,9 @@ namespace parser
 	/// top ::= (definition | expression)*
 	bool Parser::parse_body_using_existing(ptr_type<ast::BodyExpr>& body, bool is_top_level, bool has_curly_brackets)
 	{
+		// a body without curly brackets is the whole file
+		uint32_t start_offset = has_curly_brackets ? current_token().offset : 0;
+
 		if (has_curly_brackets)
 		{
 			if (curr_token != Token::BodyStart)
@@ -457,6 +216,7 @@ namespace parser
 					{
 						return log_error_bool("Body must end with a '}'");
 					}
+					body->set_source_range(sourceManager::SourceRange{filename_id, start_offset, current_token().offset});
 					return true;
 				}
 				case Token::EndOfExpression:
@@ -537,7 +297,7 @@ namespace parser
 						return false;
 					}
 
-					ast::IfExpr* if_expr = dynamic_cast<ast::IfExpr*>(base.get());
+					ast::IfExpr* if_expr = ast::expr_cast<ast::IfExpr>(base.get());
 					if_expr->should_return_value = false;
 
 					body->add_base(std::move(base));
@@ -600,7 +360,8 @@ namespace parser
 				}
 				case Token::Comment:
 				{
-					parse_comment();
+					// the comment text has already been skipped by the lexer
+					curr_token = Token::EndOfExpression;
 					break;
 				}
 				case Token::ReturnStatement:
@@ -719,6 +480,8 @@ namespace parser
 				}
 				case Token::BodyEnd:
 				{
+					body->set_source_range(sourceManager::SourceRange{
+						filename_id, start_offset, current_token().offset + current_token().length});
 					return true;
 				}
 				default:
@@ -845,7 +608,7 @@ namespace parser
 
 				if (expr != nullptr)
 				{
-					ast::IfExpr* if_expr = dynamic_cast<ast::IfExpr*>(expr.get());
+					ast::IfExpr* if_expr = ast::dyn_expr_cast<ast::IfExpr>(expr.get());
 					if (if_expr != nullptr && if_expr->should_return_value == false)
 					{
 						return log_error("If expression must have an else statement");
@@ -868,11 +631,14 @@ namespace parser
 		// allows cast to be chained
 		while (true)
 		{
-			char next_char = peek_char();
+			const LexedToken& last_token = current_token();
+			uint32_t last_token_end = last_token.offset + last_token.length;
 
 			get_next_token();
 
-			if (next_char == '<')
+			// a '<' directly after the expression starts a cast
+			if (current_token().offset == last_token_end && current_token().length > 0 &&
+				buffer_start[current_token().offset] == '<')
 			{
 				// parse cast
 				expr = parse_cast(std::move(expr));
@@ -904,7 +670,7 @@ namespace parser
 				return std::move(lhs);
 			}
 
-			operators::BinaryOp binop_type = operators::is_binary_op(identifier_string);
+			operators::BinaryOp binop_type = current_token().binop;
 			if (binop_type == operators::BinaryOp::None)
 			{
 				return log_error("Binary operator is invalid");
@@ -939,7 +705,9 @@ namespace parser
 				}
 			}
 
-			lhs = std::move(make_ptr<ast::BinaryExpr>(bodies.back(), binop_type, std::move(lhs), std::move(rhs)));
+			uint32_t start_offset = lhs->get_source_range().start;
+			lhs = with_source_range(
+				make_ptr<ast::BinaryExpr>(bodies.back(), binop_type, std::move(lhs), std::move(rhs)), start_offset);
 		}
 
 		return nullptr;
@@ -950,14 +718,20 @@ namespace parser
 	///   ::= unop expression
 	ptr_type<ast::BaseExpr> Parser::parse_unary()
 	{
-		// if current char is not a unary op, then it is a primary expression
-		if (operators::is_unary_op(last_char) == operators::UnaryOp::None)
+		// get the unary operator
+		operators::UnaryOp unop = operators::UnaryOp::None;
+		if (current_token().length == 1)
+		{
+			unop = operators::is_unary_op(current_char());
+		}
+
+		// if current token is not a unary op, then it is a primary expression
+		if (unop == operators::UnaryOp::None)
 		{
 			return parse_primary();
 		}
 
-		// get the unary operator
-		operators::UnaryOp unop = operators::is_unary_op(last_char);
+		uint32_t start_offset = current_token().offset;
 
 		get_next_token();
 
@@ -967,7 +741,7 @@ namespace parser
 			return nullptr;
 		}
 
-		return make_ptr<ast::UnaryExpr>(bodies.back(), unop, std::move(expr));
+		return with_source_range(make_ptr<ast::UnaryExpr>(bodies.back(), unop, std::move(expr)), start_offset);
 	}
 
 	/// literal_expr ::= 'curr_type'
@@ -978,26 +752,27 @@ namespace parser
 			return log_error("Literal is not a valid type");
 		}
 
-		std::string literal_string = identifier_string;
-
-		// check if literal if whithin the correct range
-		// TODO: not ignore float
-		if (!types::check_range(literal_string, curr_type))
+		// the lexer has already parsed the value, and checked that it is within the range of the type
+		const types::Literal& literal = current_token().literal;
+		if (!literal.in_range)
 		{
 			return log_error("Literal value for type: " + curr_type.to_string() + " is out of range");
 		}
 
 		// next token will be eaten in parse_primary
 
-		return make_ptr<ast::LiteralExpr>(bodies.back(), curr_type, literal_string);
+		return with_source_range(
+			make_ptr<ast::LiteralExpr>(bodies.back(), curr_type, literal.value), current_token().offset);
 	}
 
 	/// variable_declaration_expr ::= var 'curr_type' identifier ('=' expression)?
 	ptr_type<ast::BaseExpr> Parser::parse_variable_declaration()
 	{
+		uint32_t start_offset = current_token().offset;
+
 		get_next_token();
 
-		types::Type var_type = types::is_valid_type(identifier_string);
+		types::Type var_type = current_type_name();
 
 		if (var_type.get_type_enum() == types::TypeEnum::None)
 		{
@@ -1011,12 +786,12 @@ namespace parser
 			return log_error("Expected identifier after type");
 		}
 
-		std::string name = identifier_string;
+		int name_id = current_token().identifier_id;
 		get_next_token();
 
 		ptr_type<ast::BaseExpr> expr = nullptr;
 
-		if (last_char == '=')
+		if (curr_token == Token::BinaryOperator && current_token().binop == operators::BinaryOp::Assignment)
 		{
 			get_next_token();
 
@@ -1027,11 +802,8 @@ namespace parser
 			}
 		}
 
-		int name_id = stringManager::get_id(name);
-
-		// TODO: check for crash
-		expr->get_body()->named_types[name_id] = var_type;
-		return make_ptr<ast::VariableDeclarationExpr>(bodies.back(), var_type, name_id, std::move(expr));
+		return with_source_range(
+			make_ptr<ast::VariableDeclarationExpr>(bodies.back(), var_type, name_id, std::move(expr)), start_offset);
 	}
 
 	/// variable_reference_expr
@@ -1039,7 +811,8 @@ namespace parser
 	///   ::= identifier '(' expression* ')'
 	ptr_type<ast::BaseExpr> Parser::parse_variable_reference()
 	{
-		int name_id = stringManager::get_id(identifier_string);
+		int name_id = current_token().identifier_id;
+		uint32_t start_offset = current_token().offset;
 
 		// peek at next token
 		Token next_token = peek_next_token();
@@ -1048,7 +821,7 @@ namespace parser
 		if (next_token != Token::ParenStart)
 		{
 			// next token will be eaten in parse_primary
-			return make_ptr<ast::VariableReferenceExpr>(bodies.back(), name_id);
+			return with_source_range(make_ptr<ast::VariableReferenceExpr>(bodies.back(), name_id), start_offset);
 		}
 
 		// eat '(' token
@@ -1057,7 +830,7 @@ namespace parser
 		get_next_token();
 
 		// function call
-		std::vector<ptr_type<ast::BaseExpr>> args;
+		ast::NodeVector<ptr_type<ast::BaseExpr>> args;
 		if (curr_token != Token::ParenEnd)
 		{
 			while (true)
@@ -1088,7 +861,12 @@ namespace parser
 
 		// next token will be eaten in parse_primary
 
-		return make_ptr<ast::CallExpr>(bodies.back(), name_id, args);
+		// the ')' has not been eaten yet
+		sourceManager::SourceRange source_range{filename_id, start_offset, current_token().offset + current_token().length};
+
+		ptr_type<ast::BaseExpr> call_expr = make_ptr<ast::CallExpr>(bodies.back(), name_id, args);
+		call_expr->set_source_range(source_range);
+		return call_expr;
 	}
 
 	ptr_type<ast::BaseExpr> Parser::parse_parenthesis()
@@ -1122,7 +900,7 @@ namespace parser
 			return nullptr;
 		}
 
-		types::Type return_type = types::is_valid_type(identifier_string);
+		types::Type return_type = current_type_name();
 
 		if (return_type.get_type_enum() == types::TypeEnum::None)
 		{
@@ -1138,7 +916,7 @@ namespace parser
 			return nullptr;
 		}
 
-		std::string name = identifier_string;
+		std::string name{token_text(current_token())};
 
 		get_next_token();
 
@@ -1163,7 +941,7 @@ namespace parser
 					return nullptr;
 				}
 
-				types.push_back(types::is_valid_type(identifier_string));
+				types.push_back(current_type_name());
 
 				get_next_token();
 				if (curr_token != Token::VariableReference)
@@ -1172,7 +950,7 @@ namespace parser
 					return nullptr;
 				}
 
-				args.push_back(stringManager::get_id(identifier_string));
+				args.push_back(current_token().identifier_id);
 
 				get_next_token();
 
@@ -1246,11 +1024,6 @@ namespace parser
 			return nullptr;
 		}
 
-		for (int i = 0; i < proto->args.size(); i++)
-		{
-			body->named_types[proto->args[i]] = proto->types[i];
-		}
-
 		body->parent_function = proto;
 
 		get_next_token();
@@ -1262,6 +1035,8 @@ namespace parser
 	// '{' expression* '}')?
 	ptr_type<ast::BaseExpr> Parser::parse_if_else(bool should_return_value)
 	{
+		uint32_t start_offset = current_token().offset;
+
 		get_next_token();
 
 		ptr_type<ast::BaseExpr> if_cond = parse_expression(false, true);
@@ -1359,12 +1134,15 @@ namespace parser
 			}
 		}
 
-		return previous_if_expr;
+		// the else if expressions share the range of the whole if expression
+		return with_source_range(std::move(previous_if_expr), start_offset);
 	}
 
 	/// forexpr ::= 'for' 'type' identifier '=' expr ';' expr (';' expr)? '{' expression* '}'
 	ptr_type<ast::BaseExpr> Parser::parse_for_loop()
 	{
+		uint32_t start_offset = current_token().offset;
+
 		ptr_type<ast::BodyExpr> for_loop_body = make_ptr<ast::BodyExpr>(this->bodies.back(), ast::BodyType::Loop);
 		this->bodies.push_back(for_loop_body.get());
 
@@ -1382,7 +1160,7 @@ namespace parser
 			return log_error("Expected type after for");
 		}
 
-		types::Type var_type = types::is_valid_type(identifier_string);
+		types::Type var_type = current_type_name();
 
 		if (var_type.get_type_enum() == types::TypeEnum::None)
 		{
@@ -1396,11 +1174,11 @@ namespace parser
 			return log_error("Expected identifier after type");
 		}
 
-		int name_id = stringManager::get_id(identifier_string);
+		int name_id = current_token().identifier_id;
 
 		get_next_token();
 
-		if (last_char != '=')
+		if (curr_token != Token::BinaryOperator || current_token().binop != operators::BinaryOp::Assignment)
 		{
 			return log_error("Expected '=' after identifier");
 		}
@@ -1461,21 +1239,23 @@ namespace parser
 
 		get_next_token();
 
-		start_expr->get_body()->named_types[name_id] = var_type;
-
-		return make_ptr<ast::ForExpr>(
-			bodies.back(),
-			var_type,
-			name_id,
-			std::move(start_expr),
-			std::move(end_expr),
-			std::move(step_expr),
-			std::move(for_loop_body));
+		return with_source_range(
+			make_ptr<ast::ForExpr>(
+				bodies.back(),
+				var_type,
+				name_id,
+				std::move(start_expr),
+				std::move(end_expr),
+				std::move(step_expr),
+				std::move(for_loop_body)),
+			start_offset);
 	}
 
 	/// whileexpr ::= 'while' expr '{' expression* '}'
 	ptr_type<ast::BaseExpr> Parser::parse_while_loop()
 	{
+		uint32_t start_offset = current_token().offset;
+
 		get_next_token();
 
 		ptr_type<ast::BaseExpr> end_expr = parse_expression(false, true);
@@ -1496,25 +1276,15 @@ namespace parser
 
 		get_next_token();
 
-		return make_ptr<ast::WhileExpr>(bodies.back(), std::move(end_expr), std::move(while_body));
-	}
-
-	ptr_type<ast::BaseExpr> Parser::parse_comment()
-	{
-		// skip till end of line
-		while (last_char != '\n')
-		{
-			last_char = get_char();
-		}
-
-		curr_token = Token::EndOfExpression;
-
-		return make_ptr<ast::CommentExpr>(bodies.back());
+		return with_source_range(
+			make_ptr<ast::WhileExpr>(bodies.back(), std::move(end_expr), std::move(while_body)), start_offset);
 	}
 
 	/// returnexpr ::= 'return' expr?
 	ptr_type<ast::BaseExpr> Parser::parse_return()
 	{
+		uint32_t start_offset = current_token().offset;
+
 		get_next_token();
 
 		ptr_type<ast::BaseExpr> expr;
@@ -1529,33 +1299,39 @@ namespace parser
 			}
 		}
 
-		return make_ptr<ast::ReturnExpr>(bodies.back(), std::move(expr));
+		return with_source_range(make_ptr<ast::ReturnExpr>(bodies.back(), std::move(expr)), start_offset);
 	}
 
 	/// continueexpr ::= 'continue'
 	ptr_type<ast::BaseExpr> Parser::parse_continue()
 	{
+		uint32_t start_offset = current_token().offset;
+
 		get_next_token();
 
-		return make_ptr<ast::ContinueExpr>(bodies.back());
+		return with_source_range(make_ptr<ast::ContinueExpr>(bodies.back()), start_offset);
 	}
 
 	/// breakexpr ::= 'break'
 	ptr_type<ast::BaseExpr> Parser::parse_break()
 	{
+		uint32_t start_offset = current_token().offset;
+
 		get_next_token();
 
-		return make_ptr<ast::BreakExpr>(bodies.back());
+		return with_source_range(make_ptr<ast::BreakExpr>(bodies.back()), start_offset);
 	}
 
 	/// cast_expr ::= expression<type>
 	ptr_type<ast::BaseExpr> Parser::parse_cast(ptr_type<ast::BaseExpr> expr)
 	{
-		char next_char = peek_char();
+		const LexedToken& angle_token = current_token();
+		const LexedToken& type_token = tokens[next_token_index];
 
-		if (!std::isalpha(next_char))
+		// the type must directly follow the '<'
+		if (angle_token.length != 1 || type_token.offset != angle_token.offset + 1 ||
+			!std::isalpha(buffer_start[type_token.offset]))
 		{
-			skip_char(); // eat '<'
 			return log_error("Cast Expression expected a type specifier after '<'");
 		}
 
@@ -1566,25 +1342,36 @@ namespace parser
 			return log_error("Cast Expression expected a type specifier after '<'");
 		}
 
-		int type_id = stringManager::get_id(identifier_string);
+		int type_id = current_token().identifier_id;
 
-		next_char = peek_char();
+		uint32_t type_end = current_token().offset + current_token().length;
+		const LexedToken& end_token = tokens[next_token_index];
 
-		skip_char(); // eat '>'
-
-		if (next_char != '>')
+		// the '>' must directly follow the type
+		if (end_token.offset != type_end || end_token.length == 0 || buffer_start[end_token.offset] != '>')
 		{
 			return log_error("Cast Expression expected '>' after type specifier");
 		}
 
+		// only eat the '>' of a two character operator
+		if (end_token.length > 1)
+		{
+			split_next_token();
+		}
+
+		get_next_token(); // eat '>'
+
 		// next token will be eaten in parse_primary
 
-		return make_ptr<ast::CastExpr>(bodies.back(), type_id, std::move(expr));
+		uint32_t start_offset = expr->get_source_range().start;
+		return with_source_range(make_ptr<ast::CastExpr>(bodies.back(), type_id, std::move(expr)), start_offset);
 	}
 
 	/// switchexpr ::= 'switch' '{' ('case:' body)* ('default:' body)? '}'
 	ptr_type<ast::BaseExpr> Parser::parse_switch_case()
 	{
+		uint32_t start_offset = current_token().offset;
+
 		get_next_token();
 
 		ptr_type<ast::BaseExpr> value_expr = parse_expression(false, true);
@@ -1601,7 +1388,7 @@ namespace parser
 
 		get_next_token();
 
-		std::vector<ptr_type<ast::CaseExpr>> cases;
+		ast::NodeVector<ptr_type<ast::CaseExpr>> cases;
 
 		bool has_default_case = false;
 
@@ -1614,6 +1401,8 @@ namespace parser
 
 			ptr_type<ast::BaseExpr> value_expr = nullptr;
 
+			uint32_t case_start_offset = current_token().offset;
+
 			bool is_default_case = this->curr_token == Token::DefaultStatement;
 
 			if (is_default_case)
@@ -1626,7 +1415,7 @@ namespace parser
 				has_default_case = true;
 
 				// TODO: temp use empty Expression
-				value_expr = make_ptr<ast::CommentExpr>(bodies.back());
+				value_expr = with_source_range(make_ptr<ast::CommentExpr>(bodies.back()), case_start_offset);
 
 				get_next_token();
 			}
@@ -1660,6 +1449,7 @@ namespace parser
 			// TODO: check if bodies.back() is correct for this use case
 			cases.push_back(
 				make_ptr<ast::CaseExpr>(bodies.back(), std::move(value_expr), std::move(body_expr), is_default_case));
+			cases.back()->set_source_range(get_source_range(case_start_offset));
 		}
 
 		if (this->curr_token != Token::BodyEnd)
@@ -1669,7 +1459,7 @@ namespace parser
 
 		get_next_token();
 
-		return make_ptr<ast::SwitchExpr>(bodies.back(), std::move(value_expr), cases);
+		return with_source_range(make_ptr<ast::SwitchExpr>(bodies.back(), std::move(value_expr), cases), start_offset);
 	}
 
 	/// moduleexpr ::= 'module' identifier
@@ -1683,7 +1473,7 @@ namespace parser
 			return false;
 		}
 
-		int module_id = stringManager::get_id(identifier_string);
+		int module_id = current_token().identifier_id;
 
 		get_next_token();
 
@@ -1729,7 +1519,7 @@ namespace parser
 		}
 		else
 		{
-			ast::BinaryExpr* expr = dynamic_cast<ast::BinaryExpr*>(base_expr.get());
+			ast::BinaryExpr* expr = ast::expr_cast<ast::BinaryExpr>(base_expr.get());
 			// lhs will contain any other scope binops and variable references
 			// but rhs will only contain call expressions
 
@@ -1758,7 +1548,7 @@ namespace parser
 					}
 					if (lhs_type == ast::AstExprType::BinaryExpr)
 					{
-						scope_expr = dynamic_cast<ast::BinaryExpr*>(scope_expr->lhs.get());
+						scope_expr = ast::expr_cast<ast::BinaryExpr>(scope_expr->lhs.get());
 						continue;
 					}
 					else
@@ -1784,11 +1574,11 @@ namespace parser
 		if (base_expr->get_type() == ast::AstExprType::BinaryExpr)
 		{
 			module_id =
-				mangler::add_mangled_name(-1, mangler::mangle_using(dynamic_cast<ast::BinaryExpr*>(base_expr.get())));
+				mangler::add_mangled_name(-1, mangler::mangle_using(ast::expr_cast<ast::BinaryExpr>(base_expr.get())));
 		}
 		else
 		{
-			module_id = mangler::add_module(-1, dynamic_cast<ast::VariableReferenceExpr*>(base_expr.get())->name_id);
+			module_id = mangler::add_module(-1, ast::expr_cast<ast::VariableReferenceExpr>(base_expr.get())->name_id);
 		}
 
 		using_modules.insert(module_id);
@@ -1798,20 +1588,13 @@ namespace parser
 
 	int Parser::get_token_precedence()
 	{
-		if (std::isalpha(last_char))
+		if (curr_token != Token::BinaryOperator)
 		{
 			return -1;
 		}
 
-		operators::BinaryOp binop = operators::is_binary_op(identifier_string);
-
 		// Make sure it's a declared binop.
-		auto f = binop_precedence.find(binop);
-		if (f == binop_precedence.end())
-		{
-			return -1;
-		}
-		int token_precedence = f->second;
+		int token_precedence = operators::get_precedence(current_token().binop);
 		if (token_precedence <= 0)
 		{
 			return -1;
@@ -1829,8 +1612,8 @@ namespace parser
 			// use filename as first module
 			// name = file<hash of filename>
 			std::string name = "file";
-			std::string filename = stringManager::get_string(this->filename_id);
-			name += std::to_string(std::hash<std::string>{}(filename));
+			std::string_view filename = stringManager::get_string(this->filename_id);
+			name += std::to_string(std::hash<std::string_view>{}(filename));
 			current_module = mangler::add_module(-1, stringManager::get_id(name));
 		}
 
@@ -1869,22 +1652,57 @@ namespace parser
 
 	void Parser::log_line_info() const
 	{
+		const LexedToken& token = current_token();
+
+		// the line is only shown up to the end of the token
+		int line_index = sourceManager::get_line_index(this->filename_id, token.offset);
+		const char* line_start = buffer_start + sourceManager::get_line_start(this->filename_id, line_index);
+		const char* token_start = buffer_start + token.offset;
+		const char* token_end = token_start + token.length;
+
+		int line_pos_start = 0;
+		int line_pos = 0;
+		std::string line;
+
+		for (const char* c = line_start; c != token_end; c++)
+		{
+			if (c == token_start)
+			{
+				line_pos_start = line_pos + 1;
+			}
+
+			if (*c == '\r')
+			{
+				// ignore
+				continue;
+			}
+
+			// convert tab to space
+			line += *c == '\t' ? ' ' : *c;
+			line_pos++;
+		}
+
+		if (token.length == 0)
+		{
+			line_pos_start = line_pos;
+		}
+
 		std::cout << '\t' << "File: " << stringManager::get_string(this->filename_id) << std::endl;
-		std::cout << '\t' << "Current Character: " << last_char << std::endl;
+		std::cout << '\t' << "Current Character: " << current_char() << std::endl;
 		// std::cout << '\t' << "curr token: " << (int) curr_token << ", last char: " << last_char << std::endl;
-		if (identifier_string != "")
+		if (Lexer::has_identifier_string(token.token) || token.length > 1)
 		{
-			std::cout << '\t' << "Identifier String: " << identifier_string << std::endl;
+			std::cout << '\t' << "Identifier String: " << token_text(token) << std::endl;
 		}
 		else
 		{
 		}
 
-		std::cout << '\t' << "At Line: " << line_info.line_count << " Position: " << line_info.line_pos << std::endl;
+		std::cout << '\t' << "At Line: " << line_index << " Position: " << line_pos << std::endl;
 
-		std::cout << '\t' << line_info.line << std::endl;
-		std::cout << '\t' << std::setfill(' ') << std::setw(line_info.line_pos_start - 1) << "";
-		std::cout << std::setfill('~') << std::setw(line_info.line_pos - line_info.line_pos_start + 1);
+		std::cout << '\t' << line << std::endl;
+		std::cout << '\t' << std::setfill(' ') << std::setw(line_pos_start - 1) << "";
+		std::cout << std::setfill('~') << std::setw(line_pos - line_pos_start + 1);
 		std::cout << '^' << std::endl;
 		std::cout << std::endl;
 	}
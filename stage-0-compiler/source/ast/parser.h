@@ -1,72 +1,35 @@
 #pragma once
 
 #include <filesystem>
-#include <fstream>
-#include <unordered_map>
 #include <unordered_set>
 
+#include "llvm/Support/MemoryBuffer.h"
+
 #include "../config.h"
 #include "ast.h"
+#include "lexer.h"
 
 namespace parser
 {
-	enum class Token
-	{
-		EndOfFile,
-		EndOfExpression,
-		VariableDeclaration,
-		VariableReference,
-		LiteralValue,
-		BinaryOperator,
-		FunctionDefinition,
-		ExternFunction,
-		IfStatement,
-		ElseStatement,
-		ForStatement,
-		WhileStatement,
-		ReturnStatement,
-		ContinueStatement,
-		BreakStatement,
-		SwitchStatement,
-		CaseStatement,
-		DefaultStatement,
-		ModuleStatement,
-		UsingStatement,
-		BodyStart,
-		BodyEnd,
-		ParenStart,
-		ParenEnd,
-		AngleStart,
-		AngleEnd,
-		Comma,
-		Comment,
-		None,
-	};
-
-	class LineInfo
-	{
-	public:
-		int line_count = 0;
-		int line_pos_start = 0;
-		int line_pos = 0;
-		std::string line;
-	};
-
 	class Parser
 	{
 	public:
-		Parser(std::ifstream& input_file, const std::string& file_name);
+		Parser(const llvm::MemoryBuffer& input_buffer, const std::string& file_name);
 
 		ptr_type<ast::BaseExpr> parse_file();
 		ptr_type<ast::FunctionDefinition> parse_file_as_func();
 		ptr_type<ast::BodyExpr> parse_file_as_body();
 		int get_module();
-		static const std::unordered_map<operators::BinaryOp, int> binop_precedence;
 
 	private:
-		char get_char();
-		char peek_char();
-		void skip_char();
+		const LexedToken& current_token() const;
+		std::string_view token_text(const LexedToken& token) const;
+		char current_char() const;
+		types::Type current_type_name() const;
+		sourceManager::SourceRange get_source_range(uint32_t start_offset) const;
+		ptr_type<ast::BaseExpr> with_source_range(ptr_type<ast::BaseExpr> expr, uint32_t start_offset) const;
+		void split_next_token();
+		void relex_tokens(size_t token_index, uint32_t offset);
 		Token peek_next_token();
 		Token get_next_token();
 		ptr_type<ast::BodyExpr> parse_body(ast::BodyType body_type, bool is_top_level, bool has_curly_brackets);
@@ -86,7 +49,6 @@ namespace parser
 		ptr_type<ast::BaseExpr> parse_if_else(bool should_return_value);
 		ptr_type<ast::BaseExpr> parse_for_loop();
 		ptr_type<ast::BaseExpr> parse_while_loop();
-		ptr_type<ast::BaseExpr> parse_comment();
 		ptr_type<ast::BaseExpr> parse_return();
 		ptr_type<ast::BaseExpr> parse_continue();
 		ptr_type<ast::BaseExpr> parse_break();
@@ -104,13 +66,16 @@ namespace parser
 		void log_line_info() const;
 
 	private:
-		std::ifstream& input_file;
-		std::string identifier_string;
-		char last_char = '\0';
+		// the whole file is held in one contiguous buffer, tokens refer back into it by offset
+		const char* buffer_start;
+		const char* buffer_end;
+		Lexer lexer;
+		std::vector<LexedToken> tokens;
+		size_t token_index = 0;
+		size_t next_token_index = 0;
 		Token curr_token = Token::None;
 		types::Type curr_type{ types::TypeEnum::None };
 		std::vector<ast::BodyExpr*> bodies;
-		LineInfo line_info;
 		std::string file_name;
 		int filename_id;
 		int current_module = -1;
@@ -0,0 +1,271 @@
+#include "scanner.h"
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SCANNER_X86_64 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// gcc and clang only allow the avx2 intrinsics in functions that are marked as using avx2,
+// msvc allows them anywhere
+#if defined(__GNUC__) || defined(__clang__)
+#define SCANNER_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SCANNER_TARGET_AVX2
+#endif
+
+namespace scanner
+{
+	namespace
+	{
+		using ScanFunction = const char* (*)(const char* ptr, const char* end);
+
+		class ScanFunctions
+		{
+		public:
+			ScanFunction skip_whitespace;
+			ScanFunction skip_line;
+			ScanFunction skip_identifier;
+		};
+
+		// same as std::isspace in the "C" locale
+		inline bool is_whitespace(char c)
+		{
+			return c == ' ' || (c >= '\t' && c <= '\r');
+		}
+
+		inline bool is_identifier(char c)
+		{
+			char lower = c | 0x20;
+			return (lower >= 'a' && lower <= 'z') || (c >= '0' && c <= '9') || c == '_';
+		}
+
+		const char* skip_whitespace_scalar(const char* ptr, const char* end)
+		{
+			while (ptr != end && is_whitespace(*ptr))
+			{
+				ptr++;
+			}
+			return ptr;
+		}
+
+		const char* skip_line_scalar(const char* ptr, const char* end)
+		{
+			while (ptr != end && *ptr != '\n')
+			{
+				ptr++;
+			}
+			return ptr;
+		}
+
+		const char* skip_identifier_scalar(const char* ptr, const char* end)
+		{
+			while (ptr != end && is_identifier(*ptr))
+			{
+				ptr++;
+			}
+			return ptr;
+		}
+
+#ifdef SCANNER_X86_64
+		inline unsigned int count_trailing_zeros(uint32_t mask)
+		{
+#if defined(_MSC_VER) && !defined(__clang__)
+			unsigned long index;
+			_BitScanForward(&index, mask);
+			return index;
+#else
+			return __builtin_ctz(mask);
+#endif
+		}
+
+		// The vector versions build a mask of the characters that end the run,
+		// the characters are compared as signed bytes, so anything >= 0x80 is never in a range.
+
+		inline __m128i whitespace_sse2(__m128i chars)
+		{
+			__m128i space = _mm_cmpeq_epi8(chars, _mm_set1_epi8(' '));
+			__m128i control = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('\t' - 1)),
+											_mm_cmplt_epi8(chars, _mm_set1_epi8('\r' + 1)));
+			return _mm_or_si128(space, control);
+		}
+
+		inline __m128i identifier_sse2(__m128i chars)
+		{
+			__m128i lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+			__m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+										  _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+			__m128i digit = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)),
+										  _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1)));
+			__m128i underscore = _mm_cmpeq_epi8(chars, _mm_set1_epi8('_'));
+			return _mm_or_si128(_mm_or_si128(alpha, digit), underscore);
+		}
+
+		const char* skip_whitespace_sse2(const char* ptr, const char* end)
+		{
+			while (end - ptr >= 16)
+			{
+				__m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+				uint32_t mask = ~static_cast<uint32_t>(_mm_movemask_epi8(whitespace_sse2(chars))) & 0xFFFF;
+				if (mask != 0)
+				{
+					return ptr + count_trailing_zeros(mask);
+				}
+				ptr += 16;
+			}
+			return skip_whitespace_scalar(ptr, end);
+		}
+
+		const char* skip_line_sse2(const char* ptr, const char* end)
+		{
+			while (end - ptr >= 16)
+			{
+				__m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+				uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, _mm_set1_epi8('\n'))));
+				if (mask != 0)
+				{
+					return ptr + count_trailing_zeros(mask);
+				}
+				ptr += 16;
+			}
+			return skip_line_scalar(ptr, end);
+		}
+
+		const char* skip_identifier_sse2(const char* ptr, const char* end)
+		{
+			while (end - ptr >= 16)
+			{
+				__m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+				uint32_t mask = ~static_cast<uint32_t>(_mm_movemask_epi8(identifier_sse2(chars))) & 0xFFFF;
+				if (mask != 0)
+				{
+					return ptr + count_trailing_zeros(mask);
+				}
+				ptr += 16;
+			}
+			return skip_identifier_scalar(ptr, end);
+		}
+
+		SCANNER_TARGET_AVX2 inline __m256i whitespace_avx2(__m256i chars)
+		{
+			__m256i space = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8(' '));
+			__m256i control = _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8('\t' - 1)),
+											   _mm256_cmpgt_epi8(_mm256_set1_epi8('\r' + 1), chars));
+			return _mm256_or_si256(space, control);
+		}
+
+		SCANNER_TARGET_AVX2 inline __m256i identifier_avx2(__m256i chars)
+		{
+			__m256i lower = _mm256_or_si256(chars, _mm256_set1_epi8(0x20));
+			__m256i alpha = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+											 _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower));
+			__m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8('0' - 1)),
+											 _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), chars));
+			__m256i underscore = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('_'));
+			return _mm256_or_si256(_mm256_or_si256(alpha, digit), underscore);
+		}
+
+		SCANNER_TARGET_AVX2 const char* skip_whitespace_avx2(const char* ptr, const char* end)
+		{
+			while (end - ptr >= 32)
+			{
+				__m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+				uint32_t mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(whitespace_avx2(chars)));
+				if (mask != 0)
+				{
+					return ptr + count_trailing_zeros(mask);
+				}
+				ptr += 32;
+			}
+			return skip_whitespace_sse2(ptr, end);
+		}
+
+		SCANNER_TARGET_AVX2 const char* skip_line_avx2(const char* ptr, const char* end)
+		{
+			while (end - ptr >= 32)
+			{
+				__m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+				uint32_t mask =
+					static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\n'))));
+				if (mask != 0)
+				{
+					return ptr + count_trailing_zeros(mask);
+				}
+				ptr += 32;
+			}
+			return skip_line_sse2(ptr, end);
+		}
+
+		SCANNER_TARGET_AVX2 const char* skip_identifier_avx2(const char* ptr, const char* end)
+		{
+			while (end - ptr >= 32)
+			{
+				__m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+				uint32_t mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(identifier_avx2(chars)));
+				if (mask != 0)
+				{
+					return ptr + count_trailing_zeros(mask);
+				}
+				ptr += 32;
+			}
+			return skip_identifier_sse2(ptr, end);
+		}
+
+		bool cpu_supports_avx2()
+		{
+#if defined(_MSC_VER) && !defined(__clang__)
+			int registers[4];
+
+			// the os must save the ymm registers (osxsave + xgetbv)
+			__cpuid(registers, 1);
+			if ((registers[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x6) != 0x6)
+			{
+				return false;
+			}
+
+			__cpuidex(registers, 7, 0);
+			return (registers[1] & (1 << 5)) != 0;
+#else
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2");
+#endif
+		}
+#endif
+
+		ScanFunctions select_scan_functions()
+		{
+#ifdef SCANNER_X86_64
+			if (cpu_supports_avx2())
+			{
+				return {skip_whitespace_avx2, skip_line_avx2, skip_identifier_avx2};
+			}
+
+			// sse2 is always available on x86-64
+			return {skip_whitespace_sse2, skip_line_sse2, skip_identifier_sse2};
+#else
+			return {skip_whitespace_scalar, skip_line_scalar, skip_identifier_scalar};
+#endif
+		}
+
+		const ScanFunctions scan_functions = select_scan_functions();
+	}
+
+	const char* skip_whitespace(const char* ptr, const char* end)
+	{
+		return scan_functions.skip_whitespace(ptr, end);
+	}
+
+	const char* skip_line(const char* ptr, const char* end)
+	{
+		return scan_functions.skip_line(ptr, end);
+	}
+
+	const char* skip_identifier(const char* ptr, const char* end)
+	{
+		return scan_functions.skip_identifier(ptr, end);
+	}
+}
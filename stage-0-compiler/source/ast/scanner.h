@@ -0,0 +1,16 @@
+#pragma once
+
+// Scans runs of characters in the source buffer, used by the lexer for its hot loops.
+// On x86-64 the runs are scanned 16 (SSE2) or 32 (AVX2) bytes at a time, the widest
+// version supported by the cpu is picked at start up, otherwise a scalar version is used.
+namespace scanner
+{
+	// returns the first character in [ptr, end) that is not whitespace, or end
+	const char* skip_whitespace(const char* ptr, const char* end);
+
+	// returns the first '\n' in [ptr, end), or end
+	const char* skip_line(const char* ptr, const char* end);
+
+	// returns the first character in [ptr, end) that is not [a-zA-Z0-9_], or end
+	const char* skip_identifier(const char* ptr, const char* end);
+}
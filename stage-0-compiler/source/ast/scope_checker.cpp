@@ -1,147 +1,137 @@
+#include <cassert>
 #include <iostream>
 
-#include "module_manager.h"
 #include "scope_checker.h"
 
 namespace scope
 {
-	ast::BodyExpr* get_scope(const ast::CallExpr* call_expr)
+	SymbolTable::SymbolTable()
 	{
-		// checks current function, and then all the parents
-		ast::BodyExpr* body = call_expr->get_body();
-
-		// TODO: deal with function overloading
-		auto f = body->function_prototypes.find(call_expr->callee_id);
-		while (body != nullptr && f == body->function_prototypes.end())
-		{
-			body = body->get_body();
-
-			if (body != nullptr)
-			{
-				f = body->function_prototypes.find(call_expr->callee_id);
-			}
-		}
+		// the top level of a file acts like a function, so its variables get slots too
+		function_slots.push_back(0);
+	}
 
-		if (body != nullptr)
+	bool SymbolTable::enter_scope(const ast::BodyExpr* body)
+	{
+		if (!scopes.empty() && scopes.back().body == body)
 		{
-			return body;
+			return false;
 		}
 
-		// check using modules
-		return moduleManager::find_body(call_expr->callee_id);
+		scopes.push_back(Scope{body, declarations.size()});
+		return true;
 	}
 
-	ast::BodyExpr* get_scope(const ast::VariableReferenceExpr* var_ref)
+	void SymbolTable::exit_scope()
 	{
-		ast::BodyExpr* body = var_ref->get_body();
+		assert(!scopes.empty() && "no scope to exit");
 
-		auto f = body->named_types.find(var_ref->name_id);
-		while (body != nullptr && f == body->named_types.end())
+		size_t first_declaration = scopes.back().first_declaration;
+		scopes.pop_back();
+
+		while (declarations.size() > first_declaration)
 		{
-			body = body->get_body();
+			auto [kind, name_id] = declarations.back();
+			declarations.pop_back();
 
-			if (body != nullptr)
+			switch (kind)
 			{
-				f = body->named_types.find(var_ref->name_id);
+				case SymbolKind::Variable:
+				{
+					variables[name_id].pop_back();
+					break;
+				}
+				case SymbolKind::Function:
+				{
+					functions[name_id].pop_back();
+					break;
+				}
+				case SymbolKind::ExternFunction:
+				{
+					extern_functions[name_id]--;
+					break;
+				}
 			}
 		}
-
-		return body;
 	}
 
-	bool is_variable_defined(const ast::BaseExpr* expr, int name_id, ast::ReferenceType type)
+	void SymbolTable::enter_function()
 	{
-		// TODO: handle generic functions and overloading
+		function_slots.push_back(0);
+	}
 
-		const ast::BodyExpr* body = nullptr;
+	int SymbolTable::exit_function()
+	{
+		assert(function_slots.size() > 1 && "no function to exit");
 
-		if (expr->get_type() == ast::AstExprType::BodyExpr)
-		{
-			body = dynamic_cast<const ast::BodyExpr*>(expr);
-		}
-		else
-		{
-			body = expr->get_body();
-		}
+		int slot_count = function_slots.back();
+		function_slots.pop_back();
+		return slot_count;
+	}
 
-		if (body == nullptr)
+	int SymbolTable::declare_variable(int name_id, const types::Type& type)
+	{
+		std::vector<VariableDeclaration>& stack = variables[name_id];
+		if (!stack.empty() && stack.back().scope_depth == scopes.size())
 		{
-			return false;
+			return -1;
 		}
 
-		std::pair<int, ast::ReferenceType> p{ name_id, type };
-
-		auto f = std::find(body->in_scope_vars.begin(), body->in_scope_vars.end(), p);
-		while (body != nullptr &&
-			   (type == ast::ReferenceType::Function || body->body_type != ast::BodyType::Function) &&
-			   f == body->in_scope_vars.end())
-		{
-			body = body->get_body();
-
-			if (body != nullptr)
-			{
-				f = std::find(body->in_scope_vars.begin(), body->in_scope_vars.end(), p);
-			}
-		}
+		int slot = function_slots.back()++;
+		stack.push_back(VariableDeclaration{scopes.size(), function_slots.size(), VariableSymbol{slot, type}});
+		declarations.push_back({SymbolKind::Variable, name_id});
+		return slot;
+	}
 
-		if (body == nullptr)
+	const VariableSymbol* SymbolTable::find_variable(int name_id) const
+	{
+		auto f = variables.find(name_id);
+		if (f == variables.end() || f->second.empty())
 		{
-			return false;
+			return nullptr;
 		}
 
-		if (f == body->in_scope_vars.end())
+		// a variable of an enclosing function is not visible
+		const VariableDeclaration& declaration = f->second.back();
+		if (declaration.function_depth != function_slots.size())
 		{
-			return false;
+			return nullptr;
 		}
 
-		return true;
+		return &declaration.symbol;
 	}
 
-	bool find_extern_function(const ast::BaseExpr* expr, int name_id)
+	void SymbolTable::declare_function(int name_id, ast::FunctionPrototype* prototype)
 	{
-		const ast::BodyExpr* body = nullptr;
-
-		if (expr->get_type() == ast::AstExprType::BodyExpr)
-		{
-			body = dynamic_cast<const ast::BodyExpr*>(expr);
-		}
-		else
-		{
-			body = expr->get_body();
-		}
+		functions[name_id].push_back(prototype);
+		declarations.push_back({SymbolKind::Function, name_id});
+	}
 
-		if (body == nullptr)
+	ast::FunctionPrototype* SymbolTable::find_function(int name_id) const
+	{
+		auto f = functions.find(name_id);
+		if (f == functions.end() || f->second.empty())
 		{
-			return false;
+			return nullptr;
 		}
 
-		auto f = std::find(body->extern_functions.begin(), body->extern_functions.end(), name_id);
-		while (body != nullptr && f == body->extern_functions.end())
-		{
-			body = body->get_body();
-
-			if (body != nullptr)
-			{
-				f = std::find(body->extern_functions.begin(), body->extern_functions.end(), name_id);
-			}
-		}
-
-		if (body == nullptr)
-		{
-			return false;
-		}
+		return f->second.back();
+	}
 
-		if (f == body->extern_functions.end())
-		{
-			return false;
-		}
+	void SymbolTable::declare_extern_function(int name_id)
+	{
+		extern_functions[name_id]++;
+		declarations.push_back({SymbolKind::ExternFunction, name_id});
+	}
 
-		return true;
+	bool SymbolTable::is_extern_function(int name_id) const
+	{
+		auto f = extern_functions.find(name_id);
+		return f != extern_functions.end() && f->second > 0;
 	}
 
 	void scope_error(const std::string& str)
 	{
 		std::cout << str << std::endl;
 	}
-
 }
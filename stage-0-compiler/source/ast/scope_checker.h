@@ -1,13 +1,83 @@
 #pragma once
 
+#include <unordered_map>
+#include <vector>
+
 #include "ast.h"
 
 namespace scope
 {
-	ast::BodyExpr* get_scope(const ast::CallExpr* call_expr);
-	ast::BodyExpr* get_scope(const ast::VariableReferenceExpr* var_ref);
-	bool is_variable_defined(const ast::BaseExpr* expr, int name_id, ast::ReferenceType type);
-	bool find_extern_function(const ast::BaseExpr* expr, int name_id);
+	class VariableSymbol
+	{
+	public:
+		int slot;
+		types::Type type;
+	};
+
+	// The names that are in scope while a file is being checked, each name is bound once when it is checked,
+	// so the later passes never have to look a name up.
+	// Each name maps to a stack of its declarations, with the innermost at the back, and each scope keeps a list of
+	// the names it declared, so they can be popped when the scope ends.
+	// Variables are only visible within the function they are declared in, and are given a dense slot index within
+	// that function. Functions and extern functions are visible in all of the nested scopes.
+	class SymbolTable
+	{
+	public:
+		SymbolTable();
+
+		// returns false if the body already has a scope, the arguments of a function and the variable of a for loop
+		// are declared in the scope of their body, so the scope is started before the body is checked
+		bool enter_scope(const ast::BodyExpr* body);
+		void exit_scope();
+		// the slots of each function start at 0
+		void enter_function();
+		// returns the number of slots used by the function
+		int exit_function();
+
+		// returns the slot, or -1 if the variable has already been declared in the current scope
+		int declare_variable(int name_id, const types::Type& type);
+		// returns nullptr if the variable is not visible from the current scope
+		const VariableSymbol* find_variable(int name_id) const;
+		void declare_function(int name_id, ast::FunctionPrototype* prototype);
+		// returns nullptr if the function is not visible from the current scope
+		ast::FunctionPrototype* find_function(int name_id) const;
+		void declare_extern_function(int name_id);
+		bool is_extern_function(int name_id) const;
+
+	private:
+		enum class SymbolKind : uint8_t
+		{
+			Variable,
+			Function,
+			ExternFunction,
+		};
+
+		class VariableDeclaration
+		{
+		public:
+			size_t scope_depth;
+			size_t function_depth;
+			VariableSymbol symbol;
+		};
+
+		class Scope
+		{
+		public:
+			const ast::BodyExpr* body;
+			// the index of the first declaration of the scope
+			size_t first_declaration;
+		};
+
+	private:
+		std::unordered_map<int, std::vector<VariableDeclaration>> variables;
+		std::unordered_map<int, std::vector<ast::FunctionPrototype*>> functions;
+		std::unordered_map<int, int> extern_functions;
+		// every declaration of the open scopes, in order
+		std::vector<std::pair<SymbolKind, int>> declarations;
+		std::vector<Scope> scopes;
+		// the next free slot of each open function
+		std::vector<int> function_slots;
+	};
 
 	void scope_error(const std::string& str);
 }
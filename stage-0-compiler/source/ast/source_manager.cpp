@@ -0,0 +1,88 @@
+#include "source_manager.h"
+
+#include <algorithm>
+#include <cassert>
+#include <unordered_map>
+#include <vector>
+
+#include "llvm/Support/MemoryBuffer.h"
+
+#include "scanner.h"
+
+namespace sourceManager
+{
+	class SourceFile
+	{
+	public:
+		std::unique_ptr<llvm::MemoryBuffer> buffer;
+		// the offset of the start of each line, the first line always starts at 0
+		std::vector<uint32_t> line_starts;
+	};
+
+	static std::unordered_map<int, SourceFile> source_files;
+
+	const SourceFile& get_file(int file_id);
+}
+
+const sourceManager::SourceFile& sourceManager::get_file(int file_id)
+{
+	auto f = source_files.find(file_id);
+	if (f == source_files.end())
+	{
+		assert(false && "file has not been added");
+	}
+	return f->second;
+}
+
+void sourceManager::add_file(int file_id, std::unique_ptr<llvm::MemoryBuffer> buffer)
+{
+	SourceFile file;
+	file.line_starts.push_back(0);
+
+	// build the line start table once, so looking up a line is just a binary search
+	const char* buffer_start = buffer->getBufferStart();
+	const char* buffer_end = buffer->getBufferEnd();
+	for (const char* c = scanner::skip_line(buffer_start, buffer_end); c != buffer_end;
+		 c = scanner::skip_line(c + 1, buffer_end))
+	{
+		file.line_starts.push_back(static_cast<uint32_t>(c + 1 - buffer_start));
+	}
+
+	file.buffer = std::move(buffer);
+	source_files[file_id] = std::move(file);
+}
+
+const llvm::MemoryBuffer& sourceManager::get_buffer(int file_id)
+{
+	return *get_file(file_id).buffer;
+}
+
+int sourceManager::get_line_index(int file_id, uint32_t offset)
+{
+	const std::vector<uint32_t>& line_starts = get_file(file_id).line_starts;
+
+	// the line is the last one that starts at or before the offset
+	auto it = std::upper_bound(line_starts.begin(), line_starts.end(), offset);
+	return static_cast<int>(it - line_starts.begin()) - 1;
+}
+
+uint32_t sourceManager::get_line_start(int file_id, int line_index)
+{
+	return get_file(file_id).line_starts[line_index];
+}
+
+std::string_view sourceManager::get_line(int file_id, int line_index)
+{
+	const SourceFile& file = get_file(file_id);
+
+	const char* buffer_start = file.buffer->getBufferStart();
+	const char* line_start = buffer_start + file.line_starts[line_index];
+	const char* line_end = scanner::skip_line(line_start, file.buffer->getBufferEnd());
+
+	if (line_end != line_start && line_end[-1] == '\r')
+	{
+		line_end--;
+	}
+
+	return std::string_view{line_start, static_cast<size_t>(line_end - line_start)};
+}
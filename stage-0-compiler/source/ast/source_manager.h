@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace llvm
+{
+	class MemoryBuffer;
+}
+
+namespace sourceManager
+{
+	// A range of characters [start, end) in a source file, stored as byte offsets,
+	// the line and position are only worked out when they are needed for an error.
+	class SourceRange
+	{
+	public:
+		int file_id = -1;
+		uint32_t start = 0;
+		uint32_t end = 0;
+
+		bool is_valid() const { return file_id != -1; }
+	};
+
+	// takes ownership of the file buffer, the file id is the id of the file name
+	void add_file(int file_id, std::unique_ptr<llvm::MemoryBuffer> buffer);
+	const llvm::MemoryBuffer& get_buffer(int file_id);
+	// the 0 based index of the line that contains the offset
+	int get_line_index(int file_id, uint32_t offset);
+	// the offset of the first character of the line
+	uint32_t get_line_start(int file_id, int line_index);
+	// the text of the line, without the line ending
+	std::string_view get_line(int file_id, int line_index);
+}
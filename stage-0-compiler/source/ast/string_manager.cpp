@@ -1,68 +1,395 @@
 #include "string_manager.h"
 
+#include <atomic>
 #include <cassert>
-#include <list>
-#include <unordered_map>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace stringManager
 {
-	static std::unordered_map<std::string_view, int> string_to_id;
-	static std::list<std::string> id_to_string;
+	// The string bytes are stored in large blocks, which are never moved or freed,
+	// so the string_views into them stay valid for the whole program.
+	class StringArena
+	{
+	public:
+		std::string_view store(std::string_view str);
+
+	private:
+		static constexpr size_t BlockSize = 64 * 1024;
+
+		std::vector<std::unique_ptr<char[]>> blocks;
+		char* block_ptr = nullptr;
+		size_t block_remaining = 0;
+	};
+
+	class StringEntry
+	{
+	public:
+		std::string_view string;
+		size_t hash = 0;
+	};
+
+	// The entries indexed by id, stored in fixed size chunks that are never moved,
+	// so an entry can be read without a lock once its id has been handed out.
+	class EntryTable
+	{
+	public:
+		static constexpr size_t ChunkSize = 4096;
+		static constexpr size_t MaxChunks = 16384;
+
+		const StringEntry& get(int id) const;
+		// only called with the insert lock held
+		void add(int id, const StringEntry& entry);
+
+	private:
+		std::unique_ptr<std::atomic<StringEntry*>[]> chunks{new std::atomic<StringEntry*>[MaxChunks]()};
+		std::vector<std::unique_ptr<StringEntry[]>> owned_chunks;
+	};
+
+	class SlotArray
+	{
+	public:
+		explicit SlotArray(size_t size);
+
+		// -1 is an empty slot, the size is always a power of 2
+		size_t size;
+		std::unique_ptr<std::atomic<int>[]> ids;
+	};
+
+	// An open addressing hash table from string to id, the slots only hold the ids,
+	// the strings and their hashes are kept in the entry table.
+	// Lookups don't take a lock, a slot is only ever written once, and when the table grows the
+	// new slots are published as a whole, the old slots are kept so a lookup can still finish on them.
+	class StringShard
+	{
+	public:
+		StringShard();
+
+		// returns -1 if the string has not been interned, can be called without the lock
+		int find(std::string_view str, size_t hash, const EntryTable& entries) const;
+		// only called with the lock held
+		void insert(int id, size_t hash, const EntryTable& entries);
+
+		std::mutex mutex;
+
+	private:
+		void grow(const EntryTable& entries);
+
+	private:
+		std::atomic<SlotArray*> slots{nullptr};
+		std::vector<std::unique_ptr<SlotArray>> slot_arrays;
+		size_t count = 0;
+	};
+
+	// The strings are split into shards by hash, each with its own insert lock, lookups of strings
+	// that are already interned never take a lock. New ids are handed out under a single insert lock, so they
+	// stay dense, they are deterministic as long as new strings are interned from one thread at a time.
+	class StringTable
+	{
+	public:
+		StringTable();
+
+		int get_id(std::string_view str);
+		std::string_view get_string(int id) const;
+		size_t size() const;
+
+	private:
+		static constexpr size_t ShardCount = 16;
+
+		StringShard& get_shard(size_t hash);
+
+	private:
+		StringShard shards[ShardCount];
+		EntryTable entries;
+		std::atomic<size_t> string_count{0};
+
+		// guards the arena and the handing out of new ids
+		std::mutex insert_mutex;
+		StringArena arena;
+	};
+
+	// the strings that are interned before anything else, so they have fixed ids
+	static constexpr std::string_view pre_interned_strings[] = {
+		// main must be first, see main_id
+		"main",
+		// type names
+		"void",
+		"bool",
+		"char",
+		"int",
+		"float",
+		"i8",
+		"i16",
+		"i32",
+		"i64",
+		"u8",
+		"u16",
+		"u32",
+		"u64",
+		"f32",
+		"f64",
+		// keywords
+		"function",
+		"extern",
+		"if",
+		"else",
+		"var",
+		"for",
+		"while",
+		"return",
+		"continue",
+		"break",
+		"module",
+		"using",
+		"switch",
+		"case",
+		"default",
+		"true",
+		"false",
+	};
+
+	static_assert(pre_interned_strings[main_id] == "main");
 
-	int store_string(const std::string& str);
+	static StringTable& get_table();
 }
 
-int stringManager::store_string(const std::string& str)
+std::string_view stringManager::StringArena::store(std::string_view str)
 {
-	if (str == "")
+	// keep a null terminator after each string, so the data can be passed to c apis
+	size_t size = str.length() + 1;
+
+	if (size > block_remaining)
 	{
-		assert(false && "string cannot be empty");
+		// large strings get their own block, so they don't waste the rest of the current one
+		size_t block_size = size > BlockSize / 4 ? size : BlockSize;
+		blocks.push_back(std::make_unique<char[]>(block_size));
+
+		if (block_size == BlockSize)
+		{
+			block_ptr = blocks.back().get();
+			block_remaining = BlockSize;
+		}
+		else
+		{
+			std::memcpy(blocks.back().get(), str.data(), str.length());
+			blocks.back()[str.length()] = '\0';
+			return std::string_view{blocks.back().get(), str.length()};
+		}
 	}
 
-	int id = id_to_string.size();
+	char* data = block_ptr;
+	std::memcpy(data, str.data(), str.length());
+	data[str.length()] = '\0';
 
-	id_to_string.push_back(str);
+	block_ptr += size;
+	block_remaining -= size;
 
-	std::string_view sv{ id_to_string.back() };
+	return std::string_view{data, str.length()};
+}
+
+const stringManager::StringEntry& stringManager::EntryTable::get(int id) const
+{
+	StringEntry* chunk = chunks[id / ChunkSize].load(std::memory_order_acquire);
+	return chunk[id % ChunkSize];
+}
 
-	string_to_id.emplace(sv, id);
+void stringManager::EntryTable::add(int id, const StringEntry& entry)
+{
+	size_t chunk_index = id / ChunkSize;
+	if (chunk_index >= MaxChunks)
+	{
+		assert(false && "too many strings");
+	}
 
-	// std::cout << id << ": " << str << std::endl;
+	StringEntry* chunk = chunks[chunk_index].load(std::memory_order_relaxed);
+	if (chunk == nullptr)
+	{
+		owned_chunks.push_back(std::make_unique<StringEntry[]>(ChunkSize));
+		chunk = owned_chunks.back().get();
+		chunks[chunk_index].store(chunk, std::memory_order_release);
+	}
 
-	return id;
+	chunk[id % ChunkSize] = entry;
 }
 
-int stringManager::get_id(const std::string& str)
+stringManager::SlotArray::SlotArray(size_t size) : size(size), ids(new std::atomic<int>[size])
 {
-	std::string_view sv{ str };
+	for (size_t i = 0; i < size; i++)
+	{
+		ids[i].store(-1, std::memory_order_relaxed);
+	}
+}
+
+stringManager::StringShard::StringShard()
+{
+	slot_arrays.push_back(std::make_unique<SlotArray>(64));
+	slots.store(slot_arrays.back().get(), std::memory_order_release);
+}
+
+int stringManager::StringShard::find(std::string_view str, size_t hash, const EntryTable& entries) const
+{
+	const SlotArray* slot_array = slots.load(std::memory_order_acquire);
+	size_t mask = slot_array->size - 1;
 
-	auto f = string_to_id.find(sv);
-	if (f != string_to_id.end())
+	// linear probing, the table is never more than half full
+	size_t index = hash & mask;
+	while (true)
+	{
+		int id = slot_array->ids[index].load(std::memory_order_acquire);
+		if (id == -1)
+		{
+			return -1;
+		}
+
+		const StringEntry& entry = entries.get(id);
+		if (entry.hash == hash && entry.string == str)
+		{
+			return id;
+		}
+		index = (index + 1) & mask;
+	}
+}
+
+void stringManager::StringShard::insert(int id, size_t hash, const EntryTable& entries)
+{
+	count++;
+	if (count * 2 > slots.load(std::memory_order_relaxed)->size)
 	{
-		return f->second;
+		grow(entries);
 	}
 
-	return store_string(str);
+	SlotArray* slot_array = slots.load(std::memory_order_relaxed);
+	size_t mask = slot_array->size - 1;
+
+	size_t index = hash & mask;
+	while (slot_array->ids[index].load(std::memory_order_relaxed) != -1)
+	{
+		index = (index + 1) & mask;
+	}
+
+	// the entry has already been written, so publish the id after it
+	slot_array->ids[index].store(id, std::memory_order_release);
+}
+
+void stringManager::StringShard::grow(const EntryTable& entries)
+{
+	const SlotArray* old_slots = slots.load(std::memory_order_relaxed);
+	std::unique_ptr<SlotArray> new_slots = std::make_unique<SlotArray>(old_slots->size * 2);
+	size_t mask = new_slots->size - 1;
+
+	for (size_t i = 0; i < old_slots->size; i++)
+	{
+		int id = old_slots->ids[i].load(std::memory_order_relaxed);
+		if (id == -1)
+		{
+			continue;
+		}
+
+		size_t index = entries.get(id).hash & mask;
+		while (new_slots->ids[index].load(std::memory_order_relaxed) != -1)
+		{
+			index = (index + 1) & mask;
+		}
+		new_slots->ids[index].store(id, std::memory_order_relaxed);
+	}
+
+	slots.store(new_slots.get(), std::memory_order_release);
+	slot_arrays.push_back(std::move(new_slots));
+}
+
+stringManager::StringTable::StringTable()
+{
+	for (std::string_view str : pre_interned_strings)
+	{
+		get_id(str);
+	}
+}
+
+stringManager::StringShard& stringManager::StringTable::get_shard(size_t hash)
+{
+	// the low bits pick the slot within the shard, so use the high bits to pick the shard
+	return shards[(hash >> (sizeof(size_t) * 8 - 4)) % ShardCount];
+}
+
+int stringManager::StringTable::get_id(std::string_view str)
+{
+	if (str.empty())
+	{
+		assert(false && "string cannot be empty");
+	}
+
+	size_t hash = std::hash<std::string_view>{}(str);
+	StringShard& shard = get_shard(hash);
+
+	// most lookups are hits, so try without the lock first
+	int id = shard.find(str, hash, entries);
+	if (id != -1)
+	{
+		return id;
+	}
+
+	std::lock_guard<std::mutex> lock{shard.mutex};
+
+	// another thread could have added it before the lock was taken
+	id = shard.find(str, hash, entries);
+	if (id != -1)
+	{
+		return id;
+	}
+
+	{
+		std::lock_guard<std::mutex> insert_lock{insert_mutex};
+
+		id = static_cast<int>(string_count.load(std::memory_order_relaxed));
+		entries.add(id, StringEntry{arena.store(str), hash});
+		string_count.store(id + 1, std::memory_order_release);
+	}
+
+	shard.insert(id, hash, entries);
+
+	return id;
+}
+
+std::string_view stringManager::StringTable::get_string(int id) const
+{
+	return entries.get(id).string;
+}
+
+size_t stringManager::StringTable::size() const
+{
+	return string_count.load(std::memory_order_acquire);
+}
+
+stringManager::StringTable& stringManager::get_table()
+{
+	// created on first use, so the pre interned strings are always there before any other string
+	static StringTable table;
+	return table;
+}
+
+int stringManager::get_id(std::string_view str)
+{
+	return get_table().get_id(str);
 }
 
 bool stringManager::is_valid_id(int id)
 {
-	if (id < 0 || id >= id_to_string.size())
+	if (id < 0 || id >= get_table().size())
 	{
 		return false;
 	}
 	return true;
 }
 
-const std::string& stringManager::get_string(int id)
+std::string_view stringManager::get_string(int id)
 {
 	if (!is_valid_id(id))
 	{
 		assert(false && "invalid id");
 	}
 
-	// return id_to_string[id];
-	auto it = id_to_string.begin();
-	std::advance(it, id);
-	return *it;
+	return get_table().get_string(id);
 }
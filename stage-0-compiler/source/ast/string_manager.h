@@ -1,10 +1,15 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 
+// All of the functions are thread safe, the ids are dense and start at 0.
 namespace stringManager
 {
-	int get_id(const std::string& str);
+	// "main" is always the first string to be interned
+	inline constexpr int main_id = 0;
+
+	int get_id(std::string_view str);
 	bool is_valid_id(int id);
-	const std::string& get_string(int id);
+	std::string_view get_string(int id);
 }
@@ -1,23 +1,27 @@
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
+#include <unordered_set>
 
 #include "../utils.h"
 #include "constant_checker.h"
 #include "mangler.h"
 #include "scope_checker.h"
+#include "source_manager.h"
 #include "string_manager.h"
 #include "type_checker.h"
+#include "visitor.h"
 
 namespace type_checker
 {
 	TypeChecker::TypeChecker() {}
 
-	bool TypeChecker::check_types(ast::BaseExpr* body) const
+	bool TypeChecker::check_types(ast::BaseExpr* body)
 	{
 		return check_expression_dispatch(body);
 	}
 
-	bool TypeChecker::check_prototypes(ast::BodyExpr* body) const
+	bool TypeChecker::check_prototypes(ast::BodyExpr* body)
 	{
 		// check and add exported functions
 		if (body->get_body() == nullptr)
@@ -27,10 +31,7 @@ namespace type_checker
 				// if function is main with no args then don't mangle, but only on top level bodies
 				if (body->get_body() == nullptr)
 				{
-					std::string main = "main";
-					int main_id = stringManager::get_id(main);
-
-					if (proto->name_id == main_id && proto->args.size() == 0)
+					if (proto->name_id == stringManager::main_id && proto->args.size() == 0)
 					{
 						continue;
 					}
@@ -41,10 +42,12 @@ namespace type_checker
 				int func_id = moduleManager::find_function(this->current_file_id, id, true);
 				if (func_id != -1)
 				{
-					log_error(body, "Function: " + stringManager::get_string(func_id) + ", is already defined.");
+					log_error(
+						body, "Function: " + std::string{stringManager::get_string(func_id)} + ", is already defined.");
 					return false;
 				}
-				moduleManager::get_exported_functions(this->current_file_id).insert(id);
+				moduleManager::add_function_symbol(this->current_file_id, body, proto, id);
+				moduleManager::add_exported_function(id, mangler::mangle(proto));
 				body->function_prototypes.insert({id, proto});
 			}
 		}
@@ -62,56 +65,88 @@ namespace type_checker
 		std::cout << str << std::endl;
 		std::cout << '\t' << "In File: " << stringManager::get_string(this->current_file_id) << std::endl;
 
-		/*
-		// TODO: use when file is read into char array
-		ast::ExpressionLineInfo& line_info = expr->get_line_info();
+		if (expr == nullptr || !expr->get_source_range().is_valid())
+		{
+			return false;
+		}
+
+		// the line and position are worked out from the offsets now, as they are only needed for errors
+		const sourceManager::SourceRange& source_range = expr->get_source_range();
+		uint32_t last_offset = source_range.end > source_range.start ? source_range.end - 1 : source_range.start;
+
+		int start_line = sourceManager::get_line_index(source_range.file_id, source_range.start);
+		int end_line = sourceManager::get_line_index(source_range.file_id, last_offset);
+		int start_pos = source_range.start - sourceManager::get_line_start(source_range.file_id, start_line) + 1;
+		int end_pos = last_offset - sourceManager::get_line_start(source_range.file_id, end_line) + 1;
 
 		std::string lines;
 		std::string positions;
 
-		if (line_info.start_line == line_info.end_line)
+		if (start_line == end_line)
 		{
 			lines += "At Line: ";
-			lines += std::to_string(line_info.start_line);
+			lines += std::to_string(start_line);
 		}
 		else
 		{
 			lines += "At Lines: ";
-			lines += std::to_string(line_info.start_line);
+			lines += std::to_string(start_line);
 			lines += '-';
-			lines += std::to_string(line_info.end_line);
+			lines += std::to_string(end_line);
 		}
 
-		if (line_info.start_pos == line_info.end_pos)
+		if (start_pos == end_pos)
 		{
 			positions += "At Position: ";
-			positions += std::to_string(line_info.start_pos);
+			positions += std::to_string(start_pos);
 		}
 		else
 		{
 			positions += "At Positions: ";
-			positions += std::to_string(line_info.start_pos);
+			positions += std::to_string(start_pos);
 			positions += '-';
-			positions += std::to_string(line_info.end_pos);
+			positions += std::to_string(end_pos);
 		}
 
-		std::cout << lines << ' ' << positions << std::endl;
-		std::cout << '\t' << line_info.line << std::endl;
+		// convert tabs to spaces, so the positions line up
+		std::string line{sourceManager::get_line(source_range.file_id, start_line)};
+		std::replace(line.begin(), line.end(), '\t', ' ');
+
+		std::cout << '\t' << lines << ' ' << positions << std::endl;
+		std::cout << '\t' << line << std::endl;
+		if (start_line == end_line)
+		{
+			std::cout << '\t' << std::setfill(' ') << std::setw(start_pos - 1) << "";
+			std::cout << std::setfill('~') << std::setw(end_pos - start_pos + 1) << '^' << std::endl;
+		}
 		std::cout << std::endl;
-		*/
 		return false;
 	}
 
-	bool TypeChecker::check_function(ast::FunctionDefinition* func) const
+	bool TypeChecker::check_function(ast::FunctionDefinition* func)
 	{
-		// add args to scope
-		for (auto& arg : func->prototype->args)
+		symbols.enter_function();
+		symbols.enter_scope(func->body.get());
+
+		// add args to scope, they take the first slots of the function
+		for (int i = 0; i < func->prototype->args.size(); i++)
 		{
-			func->body->in_scope_vars.push_back({arg, ast::ReferenceType::Variable});
+			if (symbols.declare_variable(func->prototype->args[i], func->prototype->types[i]) == -1)
+			{
+				return log_error(
+					nullptr,
+					"Function argument: " + std::string{stringManager::get_string(func->prototype->args[i])} +
+						", has already been defined");
+			}
 		}
 
 		// check function body
-		if (!check_expression_dispatch(func->body.get()))
+		bool body_valid = check_expression_dispatch(func->body.get());
+
+		symbols.exit_scope();
+		func->slot_count = symbols.exit_function();
+
+		if (!body_valid)
 		{
 			return false;
 		}
@@ -133,7 +168,7 @@ namespace type_checker
 	}
 
 	template<>
-	bool TypeChecker::check_expression<ast::LiteralExpr>(ast::LiteralExpr* expr) const
+	bool TypeChecker::check_expression<ast::LiteralExpr>(ast::LiteralExpr* expr)
 	{
 		// check the literal type
 		if (!expr->check_types())
@@ -145,7 +180,7 @@ namespace type_checker
 	}
 
 	template<>
-	bool TypeChecker::check_expression<ast::BodyExpr>(ast::BodyExpr* body) const
+	bool TypeChecker::check_expression<ast::BodyExpr>(ast::BodyExpr* body)
 	{
 		// mangle all of the function prototypes
 		std::map<int, ast::FunctionPrototype*> function_prototypes;
@@ -155,10 +190,7 @@ namespace type_checker
 			// if function is main with no args then don't mangle, but only on top level bodies
 			if (body->get_body() == nullptr)
 			{
-				std::string main = "main";
-				int main_id = stringManager::get_id(main);
-
-				if (proto->name_id == main_id && proto->args.size() == 0)
+				if (proto->name_id == stringManager::main_id && proto->args.size() == 0)
 				{
 					function_prototypes.insert({proto->name_id, proto});
 					continue;
@@ -171,20 +203,41 @@ namespace type_checker
 
 		body->function_prototypes = function_prototypes;
 
+		for (auto& p : body->function_prototypes)
+		{
+			moduleManager::add_function_symbol(this->current_file_id, body, p.second, p.first);
+		}
+
+		// function and for loop bodies already have their scope
+		bool new_scope = symbols.enter_scope(body);
+
+		bool body_valid = check_body(body);
+
+		if (new_scope)
+		{
+			symbols.exit_scope();
+		}
+
+		return body_valid;
+	}
+
+	bool TypeChecker::check_body(ast::BodyExpr* body)
+	{
 		// check all function prototypes to make sure there are no redefinitions
 		// TODO: allow same name function in embedded scopes
 		for (auto& p : body->function_prototypes)
 		{
-			if (scope::is_variable_defined(body, p.first, ast::ReferenceType::Function))
+			if (symbols.find_function(p.first) != nullptr)
 			{
-				return log_error(body, "Function: " + stringManager::get_string(p.first) + ", is already defined");
+				return log_error(
+					body, "Function: " + std::string{stringManager::get_string(p.first)} + ", is already defined");
 			}
 
-			body->in_scope_vars.push_back({p.first, ast::ReferenceType::Function});
+			symbols.declare_function(p.first, p.second);
 			if (p.second->is_extern)
 			{
 				// add unmangled function name to extern list
-				body->extern_functions.push_back(p.second->unmangled_name_id);
+				symbols.declare_extern_function(p.second->unmangled_name_id);
 			}
 		}
 
@@ -210,24 +263,17 @@ namespace type_checker
 	}
 
 	template<>
-	bool TypeChecker::check_expression<ast::VariableDeclarationExpr>(ast::VariableDeclarationExpr* expr) const
+	bool TypeChecker::check_expression<ast::VariableDeclarationExpr>(ast::VariableDeclarationExpr* expr)
 	{
 		// check to see if we are redefining the variable, but only in the current scope
-		for (auto& p : expr->get_body()->in_scope_vars)
+		expr->slot = symbols.declare_variable(expr->name_id, expr->curr_type);
+		if (expr->slot == -1)
 		{
-			if (p.second == ast::ReferenceType::Variable)
-			{
-				if (p.first == expr->name_id)
-				{
-					return log_error(
-						expr,
-						"Variable: " + stringManager::get_string(expr->name_id) + ", has already been defined");
-				}
-			}
+			return log_error(
+				expr,
+				"Variable: " + std::string{stringManager::get_string(expr->name_id)} + ", has already been defined");
 		}
 
-		expr->get_body()->in_scope_vars.push_back({expr->name_id, ast::ReferenceType::Variable});
-
 		// check value expression
 		if (expr->expr != nullptr && !check_expression_dispatch(expr->expr.get()))
 		{
@@ -241,7 +287,7 @@ namespace type_checker
 			std::string type2 = expr->expr->get_result_type().to_string();
 			return log_error(
 				expr,
-				"Variable declaration expression for: " + stringManager::get_string(expr->name_id) +
+				"Variable declaration expression for: " + std::string{stringManager::get_string(expr->name_id)} +
 					", expected type: " + type1 + " but got type: " + type2 + " instead");
 		}
 
@@ -249,38 +295,34 @@ namespace type_checker
 	}
 
 	template<>
-	bool TypeChecker::check_expression<ast::VariableReferenceExpr>(ast::VariableReferenceExpr* expr) const
+	bool TypeChecker::check_expression<ast::VariableReferenceExpr>(ast::VariableReferenceExpr* expr)
 	{
 		// check variable has already been defined
-		if (!scope::is_variable_defined(expr, expr->name_id, ast::ReferenceType::Variable))
+		const scope::VariableSymbol* variable = symbols.find_variable(expr->name_id);
+		if (variable == nullptr)
 		{
 			return log_error(
 				expr,
-				"Variable reference for: " + stringManager::get_string(expr->name_id) +
+				"Variable reference for: " + std::string{stringManager::get_string(expr->name_id)} +
 					", is not in scope (not defined)");
 		}
 
-		// check variable is in scope
-		if (scope::get_scope(expr) == nullptr)
-		{
-			return log_error(
-				expr,
-				"Variable reference for: " + stringManager::get_string(expr->name_id) + ", is not in scope");
-		}
+		expr->bind(variable->slot, variable->type);
 
 		// chekc variable type
 		if (!expr->check_types())
 		{
 			return log_error(
 				expr,
-				"Variable reference for: " + stringManager::get_string(expr->name_id) + ", has invalid type");
+				"Variable reference for: " + std::string{stringManager::get_string(expr->name_id)} +
+					", has invalid type");
 		}
 
 		return true;
 	}
 
 	template<>
-	bool TypeChecker::check_expression<ast::BinaryExpr>(ast::BinaryExpr* expr) const
+	bool TypeChecker::check_expression<ast::BinaryExpr>(ast::BinaryExpr* expr)
 	{
 		if (expr->binop == operators::BinaryOp::ModuleScope)
 		{
@@ -312,7 +354,7 @@ namespace type_checker
 					}
 					if (lhs_type == ast::AstExprType::BinaryExpr)
 					{
-						scope_expr = dynamic_cast<ast::BinaryExpr*>(scope_expr->lhs.get());
+						scope_expr = ast::expr_cast<ast::BinaryExpr>(scope_expr->lhs.get());
 						continue;
 					}
 					else
@@ -338,12 +380,12 @@ namespace type_checker
 			{
 				module_id = mangler::add_mangled_name(
 					-1,
-					mangler::mangle_using(dynamic_cast<ast::BinaryExpr*>(expr->lhs.get())));
+					mangler::mangle_using(ast::expr_cast<ast::BinaryExpr>(expr->lhs.get())));
 			}
 			else
 			{
 				module_id =
-					mangler::add_module(-1, dynamic_cast<ast::VariableReferenceExpr*>(expr->lhs.get())->name_id);
+					mangler::add_module(-1, ast::expr_cast<ast::VariableReferenceExpr>(expr->lhs.get())->name_id);
 			}
 
 			if (!moduleManager::is_module_available(this->current_file_id, module_id))
@@ -351,14 +393,24 @@ namespace type_checker
 				return log_error(
 					expr,
 					"Binary Operator: " + operators::to_string(expr->binop) +
-						", lhs module: " + stringManager::get_string(module_id) + ", does not exist.");
+						", lhs module: " + std::string{stringManager::get_string(module_id)} + ", does not exist.");
 			}
 
 			// get rhs name id
 			int rhs_mangled_id = -1;
 			if (expr->rhs->get_type() == ast::AstExprType::CallExpr)
 			{
-				ast::CallExpr* call_expr = dynamic_cast<ast::CallExpr*>(expr->rhs.get());
+				ast::CallExpr* call_expr = ast::expr_cast<ast::CallExpr>(expr->rhs.get());
+
+				// the call is mangled with the types of its args, so they are checked first
+				for (auto& e : call_expr->args)
+				{
+					if (!check_expression_dispatch(e.get()))
+					{
+						return false;
+					}
+				}
+
 				rhs_mangled_id = mangler::mangle(module_id, call_expr);
 			}
 
@@ -368,7 +420,7 @@ namespace type_checker
 			// set rhs mangled name id
 			if (expr->rhs->get_type() == ast::AstExprType::CallExpr)
 			{
-				dynamic_cast<ast::CallExpr*>(expr->rhs.get())->callee_id = rhs_mangled_id;
+				ast::expr_cast<ast::CallExpr>(expr->rhs.get())->callee_id = rhs_mangled_id;
 			}
 
 			// check rhs
@@ -429,13 +481,17 @@ namespace type_checker
 	}
 
 	template<>
-	bool TypeChecker::check_expression<ast::CallExpr>(ast::CallExpr* expr) const
+	bool TypeChecker::check_expression<ast::CallExpr>(ast::CallExpr* expr)
 	{
-		for (auto& e : expr->args)
+		// the args of a mangled call have already been checked by the module scope operator
+		if (!expr->is_mangled())
 		{
-			if (!check_expression_dispatch(e.get()))
+			for (auto& e : expr->args)
 			{
-				return false;
+				if (!check_expression_dispatch(e.get()))
+				{
+					return false;
+				}
 			}
 		}
 
@@ -457,7 +513,8 @@ namespace type_checker
 		}
 
 		// check function has been defined in current scope
-		if (!scope::is_variable_defined(expr, id, ast::ReferenceType::Function))
+		ast::FunctionPrototype* prototype = symbols.find_function(id);
+		if (prototype == nullptr)
 		{
 			// check to see if function exists in the modules
 			int full_function_id =
@@ -466,7 +523,7 @@ namespace type_checker
 			{
 				return log_error(
 					expr,
-					"Function call for: " + stringManager::get_string(expr->callee_id) +
+					"Function call for: " + std::string{stringManager::get_string(expr->callee_id)} +
 						", is not in scope (not defined)");
 			}
 			else
@@ -478,7 +535,7 @@ namespace type_checker
 		}
 
 		// see if it is a extern function call
-		if (scope::find_extern_function(expr, expr->unmangled_callee_id))
+		if (symbols.is_extern_function(expr->unmangled_callee_id))
 		{
 			expr->is_extern = true;
 		}
@@ -486,22 +543,22 @@ namespace type_checker
 		{
 			if (!expr->is_mangled())
 			{
-				auto modules_function_is_in =
+				const std::vector<int>& modules_function_is_in =
 					moduleManager::get_matching_function_locations(this->current_file_id, no_module_id);
 
 				if (modules_function_is_in.size() > 1 ||
 					(function_is_in_same_file && modules_function_is_in.size() > 0))
 				{
 					std::string error_message =
-						"Function call for: " + stringManager::get_string(expr->unmangled_callee_id) +
+						"Function call for: " + std::string{stringManager::get_string(expr->unmangled_callee_id)} +
 						", is ambiguous (defined in multiple places)";
 
 					if (function_is_in_same_file)
 					{
 						error_message += '\n';
 						error_message += '\t';
-						error_message +=
-							"Function defined in file: " + stringManager::get_string(this->current_file_id);
+						error_message += "Function defined in file: ";
+						error_message += stringManager::get_string(this->current_file_id);
 					}
 
 					for (auto& module_id : modules_function_is_in)
@@ -519,13 +576,26 @@ namespace type_checker
 		// mangle the call id
 		expr->callee_id = id;
 
+		// the function is in another file
+		if (prototype == nullptr)
+		{
+			const moduleManager::FunctionSymbol* symbol = moduleManager::find_function_symbol(id);
+			if (symbol != nullptr)
+			{
+				prototype = symbol->prototype;
+			}
+		}
+
 		// check function is in scope
-		if (scope::get_scope(expr) == nullptr)
+		if (prototype == nullptr)
 		{
-			// return log_error(expr, "Function call for: " + stringManager::get_string(expr->callee_id) + ", is
-			// not in scope");
+			return log_error(
+				expr,
+				"Function call for: " + std::string{stringManager::get_string(expr->callee_id)} + ", is not in scope");
 		}
 
+		expr->prototype = prototype;
+
 		// check call arguments
 		if (!expr->check_types())
 		{
@@ -537,7 +607,7 @@ namespace type_checker
 	}
 
 	template<>
-	bool TypeChecker::check_expression<ast::IfExpr>(ast::IfExpr* expr) const
+	bool TypeChecker::check_expression<ast::IfExpr>(ast::IfExpr* expr)
 	{
 		// check the condition
 		if (!check_expression_dispatch(expr->condition.get()))
@@ -575,11 +645,21 @@ namespace type_checker
 	}
 
 	template<>
-	bool TypeChecker::check_expression<ast::ForExpr>(ast::ForExpr* expr) const
+	bool TypeChecker::check_expression<ast::ForExpr>(ast::ForExpr* expr)
 	{
-		// add variable to for body scope
-		expr->for_body->in_scope_vars.push_back({expr->name_id, ast::ReferenceType::Variable});
+		// add variable to for body scope, the start, end and step expressions are in the for body too
+		symbols.enter_scope(expr->for_body.get());
+		expr->slot = symbols.declare_variable(expr->name_id, expr->var_type);
 
+		bool for_valid = check_for(expr);
+
+		symbols.exit_scope();
+
+		return for_valid;
+	}
+
+	bool TypeChecker::check_for(ast::ForExpr* expr)
+	{
 		// check the start expression
 		if (!check_expression_dispatch(expr->start_expr.get()))
 		{
@@ -631,7 +711,7 @@ namespace type_checker
 	}
 
 	template<>
-	bool TypeChecker::check_expression<ast::WhileExpr>(ast::WhileExpr* expr) const
+	bool TypeChecker::check_expression<ast::WhileExpr>(ast::WhileExpr* expr)
 	{
 		// check the end condition
 		if (!check_expression_dispatch(expr->end_expr.get()))
@@ -661,13 +741,13 @@ namespace type_checker
 	}
 
 	template<>
-	bool TypeChecker::check_expression<ast::CommentExpr>(ast::CommentExpr* expr) const
+	bool TypeChecker::check_expression<ast::CommentExpr>(ast::CommentExpr* expr)
 	{
 		return true;
 	}
 
 	template<>
-	bool TypeChecker::check_expression<ast::ReturnExpr>(ast::ReturnExpr* expr) const
+	bool TypeChecker::check_expression<ast::ReturnExpr>(ast::ReturnExpr* expr)
 	{
 		// check return expression
 		if (expr->ret_expr != nullptr && !check_expression_dispatch(expr->ret_expr.get()))
@@ -698,7 +778,7 @@ namespace type_checker
 	}
 
 	template<>
-	bool TypeChecker::check_expression<ast::ContinueExpr>(ast::ContinueExpr* expr) const
+	bool TypeChecker::check_expression<ast::ContinueExpr>(ast::ContinueExpr* expr)
 	{
 		// check continue
 		if (!expr->check_types())
@@ -710,7 +790,7 @@ namespace type_checker
 	}
 
 	template<>
-	bool TypeChecker::check_expression<ast::BreakExpr>(ast::BreakExpr* expr) const
+	bool TypeChecker::check_expression<ast::BreakExpr>(ast::BreakExpr* expr)
 	{
 		// check break
 		if (!expr->check_types())
@@ -722,7 +802,7 @@ namespace type_checker
 	}
 
 	template<>
-	bool TypeChecker::check_expression<ast::UnaryExpr>(ast::UnaryExpr* expr) const
+	bool TypeChecker::check_expression<ast::UnaryExpr>(ast::UnaryExpr* expr)
 	{
 		// check expression
 		if (!check_expression_dispatch(expr->expr.get()))
@@ -752,7 +832,7 @@ namespace type_checker
 	}
 
 	template<>
-	bool TypeChecker::check_expression<ast::CastExpr>(ast::CastExpr* expr) const
+	bool TypeChecker::check_expression<ast::CastExpr>(ast::CastExpr* expr)
 	{
 		// check expression
 		if (!check_expression_dispatch(expr->expr.get()))
@@ -766,7 +846,9 @@ namespace type_checker
 		types::Type type = types::is_valid_type(stringManager::get_string(expr->target_type_id));
 		if (type.get_type_enum() == types::TypeEnum::None)
 		{
-			return log_error(expr, "Cast target type is invalid: " + stringManager::get_string(expr->target_type_id));
+			return log_error(
+				expr,
+				"Cast target type is invalid: " + std::string{stringManager::get_string(expr->target_type_id)});
 		}
 
 		expr->target_type = type;
@@ -783,7 +865,7 @@ namespace type_checker
 	}
 
 	template<>
-	bool TypeChecker::check_expression<ast::SwitchExpr>(ast::SwitchExpr* expr) const
+	bool TypeChecker::check_expression<ast::SwitchExpr>(ast::SwitchExpr* expr)
 	{
 		// check expression
 		if (!check_expression_dispatch(expr->value_expr.get()))
@@ -819,7 +901,8 @@ namespace type_checker
 		}
 
 		// make sure there are no duplicate values
-		std::vector<types::IntType> case_values;
+		std::unordered_set<uint64_t> case_values;
+		case_values.reserve(expr->cases.size());
 
 		for (auto& case_expr : expr->cases)
 		{
@@ -829,26 +912,23 @@ namespace type_checker
 			}
 
 			// TODO: make checks cleaner/simpler
-			ast::LiteralExpr* literal_expr = dynamic_cast<ast::LiteralExpr*>(case_expr->case_expr.get());
+			ast::LiteralExpr* literal_expr = ast::dyn_expr_cast<ast::LiteralExpr>(case_expr->case_expr.get());
 			if (literal_expr == nullptr)
 			{
 				return log_error(case_expr.get(), "Case value not literal expression");
 			}
 
-			types::IntType* type = dynamic_cast<types::IntType*>(literal_expr->value_type.get());
-			if (type == nullptr)
+			if (literal_expr->curr_type.get_type_enum() != types::TypeEnum::Int)
 			{
 				return log_error(case_expr.get(), "Case value must be an integer");
 			}
 
-			auto it = std::find(case_values.begin(), case_values.end(), *type);
-			if (it != case_values.end())
+			// all of the case values have the same type, so only the values need comparing
+			if (!case_values.insert(literal_expr->value.int_value).second)
 			{
-				std::string value = type->to_string();
+				std::string value = types::literal_to_string(literal_expr->curr_type, literal_expr->value);
 				return log_error(case_expr.get(), "Switch already has a case value of: " + value);
 			}
-
-			case_values.push_back(*type);
 		}
 
 		// check case
@@ -864,7 +944,7 @@ namespace type_checker
 	}
 
 	template<>
-	bool TypeChecker::check_expression<ast::CaseExpr>(ast::CaseExpr* expr) const
+	bool TypeChecker::check_expression<ast::CaseExpr>(ast::CaseExpr* expr)
 	{
 		// check case body
 		if (!this->check_expression_dispatch(expr->case_body.get()))
@@ -875,90 +955,18 @@ namespace type_checker
 		return true;
 	}
 
-	bool TypeChecker::check_expression_dispatch(ast::BaseExpr* expr) const
+	bool TypeChecker::check_expression_dispatch(ast::BaseExpr* expr)
 	{
-		switch (expr->get_type())
-		{
-			case ast::AstExprType::LiteralExpr:
-			{
-				return check_expression(dynamic_cast<ast::LiteralExpr*>(expr));
-			}
-			case ast::AstExprType::BodyExpr:
-			{
-				return check_expression(dynamic_cast<ast::BodyExpr*>(expr));
-			}
-			case ast::AstExprType::VariableDeclarationExpr:
-			{
-				return check_expression(dynamic_cast<ast::VariableDeclarationExpr*>(expr));
-			}
-			case ast::AstExprType::VariableReferenceExpr:
-			{
-				return check_expression(dynamic_cast<ast::VariableReferenceExpr*>(expr));
-			}
-			case ast::AstExprType::BinaryExpr:
-			{
-				return check_expression(dynamic_cast<ast::BinaryExpr*>(expr));
-			}
-			case ast::AstExprType::CallExpr:
-			{
-				return check_expression(dynamic_cast<ast::CallExpr*>(expr));
-			}
-			case ast::AstExprType::IfExpr:
-			{
-				return check_expression(dynamic_cast<ast::IfExpr*>(expr));
-			}
-			case ast::AstExprType::ForExpr:
-			{
-				return check_expression(dynamic_cast<ast::ForExpr*>(expr));
-			}
-			case ast::AstExprType::WhileExpr:
-			{
-				return check_expression(dynamic_cast<ast::WhileExpr*>(expr));
-			}
-			case ast::AstExprType::CommentExpr:
-			{
-				return check_expression(dynamic_cast<ast::CommentExpr*>(expr));
-			}
-			case ast::AstExprType::ReturnExpr:
-			{
-				return check_expression(dynamic_cast<ast::ReturnExpr*>(expr));
-			}
-			case ast::AstExprType::ContinueExpr:
-			{
-				return check_expression(dynamic_cast<ast::ContinueExpr*>(expr));
-			}
-			case ast::AstExprType::BreakExpr:
-			{
-				return check_expression(dynamic_cast<ast::BreakExpr*>(expr));
-			}
-			case ast::AstExprType::UnaryExpr:
-			{
-				return check_expression(dynamic_cast<ast::UnaryExpr*>(expr));
-			}
-			case ast::AstExprType::CastExpr:
-			{
-				return check_expression(dynamic_cast<ast::CastExpr*>(expr));
-			}
-			case ast::AstExprType::SwitchExpr:
-			{
-				return check_expression(dynamic_cast<ast::SwitchExpr*>(expr));
-			}
-			case ast::AstExprType::CaseExpr:
-			{
-				return check_expression(dynamic_cast<ast::CaseExpr*>(expr));
-			}
-		}
-		assert(false && "Missing Type Specialisation");
-		return false;
+		return ast::visit(expr, [this](auto* e) { return check_expression(e); });
 	}
 
-	void TypeChecker::expand_compound_assignment(ast::BinaryExpr* expr) const
+	void TypeChecker::expand_compound_assignment(ast::BinaryExpr* expr)
 	{
 		// turn a op= b into a = a op b
 
 		operators::BinaryOp op = operators::extract_compound_assignment_operator(expr->binop);
 
-		ast::VariableReferenceExpr* lhs = dynamic_cast<ast::VariableReferenceExpr*>(expr->lhs.get());
+		ast::VariableReferenceExpr* lhs = ast::dyn_expr_cast<ast::VariableReferenceExpr>(expr->lhs.get());
 		if (lhs == nullptr)
 		{
 			// NOTE: this should never be reached
@@ -969,6 +977,7 @@ namespace type_checker
 		// copy the variable reference expr
 		ptr_type<ast::VariableReferenceExpr> var_ref_expr =
 			make_ptr<ast::VariableReferenceExpr>(expr->get_body(), lhs->name_id);
+		var_ref_expr->bind(lhs->slot, lhs->get_result_type());
 
 		ptr_type<ast::BinaryExpr> op_expr =
 			make_ptr<ast::BinaryExpr>(expr->get_body(), op, std::move(var_ref_expr), std::move(expr->rhs));
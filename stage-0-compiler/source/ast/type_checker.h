@@ -2,6 +2,7 @@
 
 #include "ast.h"
 #include "module_manager.h"
+#include "scope_checker.h"
 
 namespace type_checker
 {
@@ -9,19 +10,22 @@ namespace type_checker
 	{
 	public:
 		TypeChecker();
-		bool check_types(ast::BaseExpr* body) const;
-		bool check_prototypes(ast::BodyExpr* body) const;
+		bool check_types(ast::BaseExpr* body);
+		bool check_prototypes(ast::BodyExpr* body);
 		void set_file_id(int file_id);
 
 	private:
-		bool check_function(ast::FunctionDefinition* func) const;
-		bool check_expression_dispatch(ast::BaseExpr* expr) const;
+		bool check_function(ast::FunctionDefinition* func);
+		bool check_body(ast::BodyExpr* body);
+		bool check_for(ast::ForExpr* expr);
+		bool check_expression_dispatch(ast::BaseExpr* expr);
 		template<class T, typename = std::enable_if_t<std::is_base_of_v<ast::BaseExpr, T>>>
-		bool check_expression(T* expr) const;
-		void expand_compound_assignment(ast::BinaryExpr* expr) const;
+		bool check_expression(T* expr);
+		void expand_compound_assignment(ast::BinaryExpr* expr);
 		bool log_error(const ast::BaseExpr* expr, const std::string& str) const;
 
 	private:
 		int current_file_id = -1;
+		scope::SymbolTable symbols;
 	};
 }
@@ -1,58 +1,186 @@
+#include <atomic>
+#include <cassert>
+#include <charconv>
+#include <cmath>
 #include <iostream>
-#include <regex>
+#include <mutex>
+#include <unordered_map>
 
 #include "../utils.h"
 #include "types.h"
 
 namespace types
 {
-	Type::Type() : type_enum{TypeEnum::None}, size{0}, signed_value{false} {}
+	// The types that are not primitive types, they are only ever added, so a type info is never moved
+	class TypeTable
+	{
+	public:
+		int get_id(const TypeInfo& info);
+		const TypeInfo& get(int id) const;
+
+	private:
+		static constexpr size_t ChunkSize = 256;
+		static constexpr size_t MaxChunks = 256;
 
-	Type::Type(TypeEnum type_enum) : type_enum{type_enum}, size{0}, signed_value{false}
+		std::mutex mutex;
+		// (type enum, sign, size) -> type id
+		std::unordered_map<uint64_t, int> ids;
+		std::unique_ptr<std::atomic<TypeInfo*>[]> chunks{new std::atomic<TypeInfo*>[MaxChunks]()};
+		std::vector<std::unique_ptr<TypeInfo[]>> owned_chunks;
+		int type_count = primitive_type_count;
+	};
+
+	static TypeTable& get_type_table()
 	{
-		switch (type_enum)
+		static TypeTable table;
+		return table;
+	}
+
+	int TypeTable::get_id(const TypeInfo& info)
+	{
+		uint64_t key = static_cast<uint64_t>(info.type_enum) << 32;
+		key |= static_cast<uint64_t>(info.signed_value) << 16;
+		key |= info.size;
+
+		std::lock_guard<std::mutex> lock{this->mutex};
+
+		auto [f, inserted] = this->ids.insert({key, this->type_count});
+		if (!inserted)
 		{
-			case TypeEnum::Int:
+			return f->second;
+		}
+
+		size_t index = this->type_count - primitive_type_count;
+		if (index / ChunkSize >= MaxChunks)
+		{
+			assert(false && "too many types");
+		}
+
+		TypeInfo* chunk = this->chunks[index / ChunkSize].load(std::memory_order_relaxed);
+		if (chunk == nullptr)
+		{
+			this->owned_chunks.push_back(std::make_unique<TypeInfo[]>(ChunkSize));
+			chunk = this->owned_chunks.back().get();
+			this->chunks[index / ChunkSize].store(chunk, std::memory_order_release);
+		}
+
+		chunk[index % ChunkSize] = info;
+
+		return this->type_count++;
+	}
+
+	const TypeInfo& TypeTable::get(int id) const
+	{
+		size_t index = id - primitive_type_count;
+		return this->chunks[index / ChunkSize].load(std::memory_order_acquire)[index % ChunkSize];
+	}
+
+	const TypeInfo& get_type_info(int id)
+	{
+		if (id < primitive_type_count)
+		{
+			return primitive_types[id];
+		}
+		return get_type_table().get(id);
+	}
+
+	// the primitive types are found without touching the type table
+	static int get_type_id(const TypeInfo& info)
+	{
+		int id = -1;
+
+		switch (info.type_enum)
+		{
+			case TypeEnum::None:
 			{
-				this->size = 32;
-				this->signed_value = true;
+				id = 0;
 				break;
 			}
-			case TypeEnum::Float:
+			case TypeEnum::Void:
 			{
-				this->size = 32;
-				this->signed_value = true;
+				id = 1;
 				break;
 			}
 			case TypeEnum::Bool:
 			{
-				this->size = 1;
-				this->signed_value = false;
+				id = 2;
 				break;
 			}
 			case TypeEnum::Char:
 			{
-				this->size = 8;
-				this->signed_value = true;
+				id = 3;
+				break;
+			}
+			case TypeEnum::Int:
+			{
+				// i8 i16 i32 i64, then u8 u16 u32 u64
+				int size_index = info.size == 8 ? 0 : info.size == 16 ? 1 : info.size == 32 ? 2 : 3;
+				id = 4 + size_index + (info.signed_value ? 0 : 4);
+				break;
+			}
+			case TypeEnum::Float:
+			{
+				id = info.size == 32 ? 12 : 13;
 				break;
 			}
 		}
-	}
 
-	bool Type::operator==(const Type& other) const
-	{
-		return std::tie(this->type_enum, this->size, this->signed_value) ==
-			std::tie(other.type_enum, other.size, other.signed_value);
+		const TypeInfo& primitive = primitive_types[id];
+		if (primitive.type_enum == info.type_enum && primitive.signed_value == info.signed_value &&
+			primitive.size == info.size)
+		{
+			return id;
+		}
+
+		return get_type_table().get_id(info);
 	}
 
-	bool Type::operator!=(const Type& other) const
+	Type::Type() : id{0} {}
+
+	Type::Type(TypeEnum type_enum) : id{0}
 	{
-		return !(*this == other);
+		switch (type_enum)
+		{
+			case TypeEnum::None:
+			{
+				this->id = get_type_id({TypeEnum::None, false, 0});
+				break;
+			}
+			case TypeEnum::Int:
+			{
+				this->id = get_type_id({TypeEnum::Int, true, 32});
+				break;
+			}
+			case TypeEnum::Float:
+			{
+				this->id = get_type_id({TypeEnum::Float, true, 32});
+				break;
+			}
+			case TypeEnum::Void:
+			{
+				this->id = get_type_id({TypeEnum::Void, false, 0});
+				break;
+			}
+			case TypeEnum::Bool:
+			{
+				this->id = get_type_id({TypeEnum::Bool, false, 1});
+				break;
+			}
+			case TypeEnum::Char:
+			{
+				this->id = get_type_id({TypeEnum::Char, true, 8});
+				break;
+			}
+		}
 	}
 
+	Type::Type(TypeEnum type_enum, int size, bool is_signed) :
+		id{get_type_id({type_enum, is_signed, static_cast<uint16_t>(size)})}
+	{}
+
 	std::string Type::to_string() const
 	{
-		switch (this->type_enum)
+		switch (this->get_type_enum())
 		{
 			case TypeEnum::None:
 			{
@@ -60,18 +188,18 @@ namespace types
 			}
 			case TypeEnum::Int:
 			{
-				if (this->signed_value)
+				if (this->is_signed())
 				{
-					return "i" + std::to_string(this->size);
+					return "i" + std::to_string(this->get_size());
 				}
 				else
 				{
-					return "u" + std::to_string(this->size);
+					return "u" + std::to_string(this->get_size());
 				}
 			}
 			case TypeEnum::Float:
 			{
-				return "f" + std::to_string(this->size);
+				return "f" + std::to_string(this->get_size());
 			}
 			case TypeEnum::Void:
 			{
@@ -88,54 +216,83 @@ namespace types
 		}
 	}
 
-	Type::Type(TypeEnum type_enum, int size, bool is_signed) : type_enum(type_enum), size{size}, signed_value{is_signed}
-	{}
-
-	Type::Type(const std::string& literal, TypeEnum type) : type_enum{type}, size{0}, signed_value{false}
+	// parses the whole string as a bit size, e.g. the 32 of i32
+	static bool parse_bit_size(std::string_view str, int& size)
 	{
-		char c1 = '\0';
-		char c2 = '\0';
-		if (type_enum == TypeEnum::Float)
+		if (str.empty() || str[0] == '0')
 		{
-			c1 = 'f';
-			c2 = c1;
-		}
-		else if (type_enum == TypeEnum::Int)
-		{
-			c1 = 'i';
-			c2 = 'u';
-		}
-		else
-		{
-			*this = Type{type_enum};
-			return;
+			return false;
 		}
 
-		int i = literal.length() - 1;
-		while (i > 0 && literal[i] != c1 && literal[i] != c2)
-		{
-			i--;
-		}
+		auto [end, error] = std::from_chars(str.data(), str.data() + str.size(), size);
+		return error == std::errc{} && end == str.data() + str.size();
+	}
 
-		if (i == 0 || i == literal.length() - 1)
+	static char unescape_char(char c)
+	{
+		switch (c)
 		{
-			*this = Type{type_enum};
-			return;
+			case 'a':
+			{
+				return '\a';
+			}
+			case 'b':
+			{
+				return '\b';
+			}
+			case 'f':
+			{
+				return '\f';
+			}
+			case 'n':
+			{
+				return '\n';
+			}
+			case 'r':
+			{
+				return '\r';
+			}
+			case 't':
+			{
+				return '\t';
+			}
+			case 'v':
+			{
+				return '\v';
+			}
+			case '0':
+			{
+				return '\0';
+			}
+			default:
+			{
+				// covers \', \" and \\ as well
+				return c;
+			}
 		}
+	}
 
-		*this = Type{type_enum, std::stoi(std::string{literal.begin() + i + 1, literal.end()}), literal[i] != 'u'};
+	static bool is_digit(char c)
+	{
+		return c >= '0' && c <= '9';
 	}
 
-	Type is_valid_type(const std::string& str)
+	Type is_valid_type(std::string_view str)
 	{
+		if (str.empty())
+		{
+			return Type(TypeEnum::None);
+		}
+
+		int size = 0;
+
 		if (str == "int")
 		{
 			return Type{TypeEnum::Int};
 		}
 		else if ((str[0] == 'i' || str[0] == 'u') && str.length() > 1)
 		{
-			int size = std::stoi(std::string{str.begin() + 1, str.end()});
-			if (size >= 8 && size <= 64 && (size & (size - 1)) == 0)
+			if (parse_bit_size(str.substr(1), size) && size >= 8 && size <= 64 && (size & (size - 1)) == 0)
 			{
 				return {TypeEnum::Int, size, str[0] == 'i'};
 			}
@@ -146,8 +303,7 @@ namespace types
 		}
 		else if (str[0] == 'f' && str.length() > 1)
 		{
-			int size = std::stoi(std::string{str.begin() + 1, str.end()});
-			if (size >= 32 && size <= 64 && (size & (size - 1)) == 0)
+			if (parse_bit_size(str.substr(1), size) && size >= 32 && size <= 64 && (size & (size - 1)) == 0)
 			{
 				return {TypeEnum::Float, size, true};
 			}
@@ -167,38 +323,133 @@ namespace types
 		return Type(TypeEnum::None);
 	}
 
-	std::pair<bool, Type> check_type_string(const std::string& str)
+	Literal check_type_string(std::string_view str)
 	{
 		// type formats
-		// int: [0-9][0-9]*(i(8|16|32|64)?)?
-		// float: ([0-9][0-9]*)[.]([0-9][0-9]*)(f(32|64)?)?
+		// int: [0-9][0-9]*((i|u)(8|16|32|64)?)?
+		// float: [0-9][0-9]*[.][0-9][0-9]*(f(32|64)?)?
+		// bool: true|false
 		// char: '([^']|\\.)'
 
-		std::regex int_regex{"[0-9][0-9]*((i|u)(8|16|32|64)?)?"};
-		std::regex float_regex{"[0-9][0-9]*[.][0-9][0-9]*(f(32|64)?)?"};
-		std::regex bool_regex{"(true|false)"};
-		std::regex char_regex{"'([^']|\\\\.)'"};
+		Literal literal;
 
-		std::smatch match;
+		if (str.empty())
+		{
+			return literal;
+		}
 
-		if (std::regex_match(str, match, int_regex))
+		// bool
+		if (str == "true" || str == "false")
 		{
-			return {true, {str, TypeEnum::Int}};
+			literal.type = Type{TypeEnum::Bool};
+			literal.value.bool_value = str[0] == 't';
+			return literal;
 		}
-		else if (std::regex_match(str, match, float_regex))
+
+		// char
+		if (str[0] == '\'')
 		{
-			return {true, {str, TypeEnum::Float}};
+			if (str.length() == 3 && str[1] != '\'' && str[2] == '\'')
+			{
+				literal.value.char_value = str[1];
+			}
+			else if (str.length() == 4 && str[1] == '\\' && str[3] == '\'')
+			{
+				literal.value.char_value = unescape_char(str[2]);
+			}
+			else
+			{
+				return literal;
+			}
+
+			literal.type = Type{TypeEnum::Char};
+			return literal;
+		}
+
+		size_t i = 0;
+		while (i < str.length() && is_digit(str[i]))
+		{
+			i++;
 		}
-		else if (std::regex_match(str, match, bool_regex))
+
+		if (i == 0)
 		{
-			return {true, Type{TypeEnum::Bool}};
+			return literal;
 		}
-		else if (std::regex_match(str, match, char_regex))
+
+		// float
+		if (i < str.length() && str[i] == '.')
 		{
-			return {true, Type{TypeEnum::Char}};
+			i++;
+			size_t fraction_start = i;
+			while (i < str.length() && is_digit(str[i]))
+			{
+				i++;
+			}
+
+			if (i == fraction_start)
+			{
+				return literal;
+			}
+
+			std::string_view number = str.substr(0, i);
+			int size = 32;
+
+			// optional suffix
+			if (i < str.length())
+			{
+				if (str[i] != 'f')
+				{
+					return literal;
+				}
+
+				if (i + 1 < str.length() && (!parse_bit_size(str.substr(i + 1), size) || (size != 32 && size != 64)))
+				{
+					return literal;
+				}
+			}
+
+			auto [end, error] =
+				std::from_chars(number.data(), number.data() + number.size(), literal.value.float_value);
+
+			literal.type = Type{TypeEnum::Float, size, true};
+			literal.in_range = error == std::errc{} &&
+				(size == 64 || std::isfinite(static_cast<float>(literal.value.float_value)));
+			return literal;
 		}
 
-		return {false, Type{TypeEnum::None}};
+		// int
+		std::string_view number = str.substr(0, i);
+		int size = 32;
+		bool is_signed = true;
+
+		// optional suffix, the width is also optional
+		if (i < str.length())
+		{
+			if (str[i] != 'i' && str[i] != 'u')
+			{
+				return literal;
+			}
+
+			if (i + 1 < str.length())
+			{
+				if (!parse_bit_size(str.substr(i + 1), size) || (size != 8 && size != 16 && size != 32 && size != 64))
+				{
+					return literal;
+				}
+
+				is_signed = str[i] == 'i';
+			}
+		}
+
+		auto [end, error] = std::from_chars(number.data(), number.data() + number.size(), literal.value.int_value);
+
+		// signed literals can go one past the max, as they may be negated, eg. for i8: 128 represents -128
+		uint64_t max_value = is_signed ? (1ull << (size - 1)) : (~0ull >> (64 - size));
+
+		literal.type = Type{TypeEnum::Int, size, is_signed};
+		literal.in_range = error == std::errc{} && literal.value.int_value <= max_value;
+		return literal;
 	}
 
 	llvm::Type* get_llvm_type(llvm::LLVMContext& llvm_context, const Type& type)
@@ -264,29 +515,38 @@ namespace types
 		}
 	}
 
-	bool check_range(const std::string& literal_string, const Type& type)
+	LlvmTypeTable::LlvmTypeTable(llvm::LLVMContext& llvm_context) :
+		llvm_context{llvm_context},
+		entries(primitive_type_count)
+	{}
+
+	LlvmTypeTable::Entry& LlvmTypeTable::get_entry(const Type& type)
 	{
-		switch (type.get_type_enum())
+		if (type.get_id() >= this->entries.size())
 		{
-			case types::TypeEnum::Int:
-			{
-				return IntType::check_range(literal_string);
-			}
-			case types::TypeEnum::Float:
-			{
-				// TODO: do an actual range check for floats
-				return true;
-			}
-			case types::TypeEnum::Bool:
-			{
-				return true;
-			}
-			case types::TypeEnum::Char:
-			{
-				return true;
-			}
+			this->entries.resize(type.get_id() + 1);
+		}
+		return this->entries[type.get_id()];
+	}
+
+	llvm::Type* LlvmTypeTable::get_llvm_type(const Type& type)
+	{
+		Entry& entry = this->get_entry(type);
+		if (entry.llvm_type == nullptr)
+		{
+			entry.llvm_type = types::get_llvm_type(this->llvm_context, type);
+		}
+		return entry.llvm_type;
+	}
+
+	llvm::Value* LlvmTypeTable::get_default_value(const Type& type)
+	{
+		Entry& entry = this->get_entry(type);
+		if (entry.default_value == nullptr)
+		{
+			entry.default_value = types::get_default_value(this->llvm_context, type);
 		}
-		return false;
+		return entry.default_value;
 	}
 
 	bool is_cast_valid(const Type& from, const Type& target)
@@ -371,409 +631,77 @@ namespace types
 		}
 	}
 
-	void BaseType::negate_value()
-	{
-		assert(false && "Negation not supported");
-	}
-
-	void BaseType::set_type(const Type& type)
-	{
-		this->type = type;
-	}
-
-	ptr_type<BaseType> BaseType::create_type(const Type& curr_type, const std::string& str)
+	llvm::Constant* get_literal_constant(llvm::LLVMContext& llvm_context, const Type& type, const LiteralValue& value)
 	{
-		ptr_type<BaseType> type = nullptr;
-
-		switch (curr_type.get_type_enum())
+		switch (type.get_type_enum())
 		{
 			case TypeEnum::Int:
 			{
-				type = make_ptr<IntType>(str);
-				break;
+				return llvm::ConstantInt::get(
+					llvm_context,
+					llvm::APInt(type.get_size(), value.int_value, type.is_signed()));
 			}
 			case TypeEnum::Float:
 			{
-				type = make_ptr<FloatType>(str);
-				break;
-			}
-			case TypeEnum::Bool:
-			{
-				type = make_ptr<BoolType>(str);
-				break;
-			}
-			case TypeEnum::Char:
-			{
-				type = make_ptr<CharType>(str);
-				break;
-			}
-		}
-
-		type->set_type(curr_type);
-
-		return type;
-	}
-
-	bool BaseType::is_digit(char c)
-	{
-		return c >= '0' && c <= '9';
-	}
-
-	IntType::IntType()
-	{
-		this->data = 0;
-	}
-
-	IntType::IntType(const std::string& str)
-	{
-		int i = 0;
-
-		uint64_t value = 0;
-
-		// parse the numbers
-		for (; i < str.length() && std::isdigit(str[i]); i++)
-		{
-			value = value * 10 + static_cast<uint64_t>(str[i] - '0');
-		}
-
-		// std::cout << "int " << value << std::endl;
-
-		data = value;
-	}
-
-	llvm::ConstantData* IntType::get_value(llvm::LLVMContext* llvm_context) const
-	{
-		// create 32 bit signed int type
-		return llvm::ConstantInt::get(*llvm_context, llvm::APInt(type.get_size(), data, type.is_signed()));
-	}
-
-	std::string IntType::to_string() const
-	{
-		return std::to_string((int64_t) this->data);
-	}
-
-	void IntType::negate_value()
-	{
-		this->data = -data;
-	}
-
-	bool IntType::operator==(const IntType& other) const
-	{
-		if (this->type == other.type && this->data == other.data)
-		{
-			return true;
-		}
-		return false;
-	}
-
-	bool IntType::check_range(const std::string& str)
-	{
-		Type type{str, TypeEnum::Int};
-
-		std::string int_min;
-		std::string int_max;
-		int length;
-
-		// TODO: issue with signed range, eg. for i8: 128 represents -128
-
-		switch (type.get_size())
-		{
-			case 8:
-			{
-				if (type.is_signed()) // signed
+				if (type.get_size() == 32)
 				{
-					int_min = "000";
-					int_max = "128";
+					// create 32 bit floating point number
+					return llvm::ConstantFP::get(llvm_context, llvm::APFloat((float) value.float_value));
 				}
-				else // unsigned
+				else
 				{
-					int_min = "000";
-					int_max = "255";
+					// create 64 bit floating point number
+					return llvm::ConstantFP::get(llvm_context, llvm::APFloat(value.float_value));
 				}
-				length = 3;
-				break;
 			}
-			case 16:
+			case TypeEnum::Bool:
 			{
-				if (type.is_signed()) // signed
-				{
-					int_min = "00000";
-					int_max = "32768";
-				}
-				else // unsigned
-				{
-					int_min = "00000";
-					int_max = "65535";
-				}
-				length = 5;
-				break;
+				return llvm::ConstantInt::get(llvm_context, llvm::APInt(1, value.bool_value ? 1 : 0, false));
 			}
-			case 32:
-			{
-				if (type.is_signed()) // signed
-				{
-					int_min = "0000000000";
-					int_max = "2147483648";
-				}
-				else // unsigned
-				{
-					int_min = "0000000000";
-					int_max = "4294967295";
-				}
-				length = 10;
-				break;
-			}
-			case 64:
+			case TypeEnum::Char:
 			{
-				if (type.is_signed()) // signed
-				{
-					int_min = "0000000000000000000";
-					int_max = "9223372036854775808";
-					length = 19;
-				}
-				else // unsigned
-				{
-					int_min = "00000000000000000000";
-					int_max = "18446744073709551615";
-					length = 20;
-				}
-
-				break;
+				return llvm::ConstantInt::get(llvm_context, llvm::APInt(8, value.char_value, true));
 			}
 			default:
 			{
-				return false;
-			}
-		}
-
-		std::string literal_string;
-		for (auto& c : str)
-		{
-			if (!std::isdigit(c))
-			{
-				break;
-			}
-			else
-			{
-				literal_string += c;
+				assert(false && "Invalid literal type");
+				return nullptr;
 			}
 		}
-
-		int j = 2147483649L;
-
-		// strip leading zeroes
-		while (literal_string[0] == '0' && literal_string.size() > 1)
-		{
-			literal_string.erase(literal_string.begin());
-		}
-
-		if (literal_string.size() < length)
-		{
-			return true;
-		}
-
-		if (literal_string.size() > length)
-		{
-			return false;
-		}
-
-		int cmp = literal_string.compare(int_max);
-		return cmp <= 0;
-
-		return false;
 	}
 
-	FloatType::FloatType()
+	std::string literal_to_string(const Type& type, const LiteralValue& value)
 	{
-		this->data = 0.0f;
-	}
-
-	FloatType::FloatType(const std::string& str)
-	{
-		int whole = 0;
-		int fraction = 0;
-		int decimal_power = 1;
-		bool in_fraction = false;
-
-		int i = 0;
-
-		// parse the numbers
-		for (; str[i] != 'f' && i < str.length(); i++)
+		switch (type.get_type_enum())
 		{
-			if (str[i] == '.')
+			case TypeEnum::Int:
 			{
-				if (!in_fraction)
-				{
-					in_fraction = true;
-				}
+				return std::to_string((int64_t) value.int_value);
 			}
-			else
+			case TypeEnum::Float:
+			{
+				return std::to_string(value.float_value);
+			}
+			case TypeEnum::Bool:
 			{
-				if (!in_fraction)
+				if (value.bool_value)
 				{
-					whole = whole * 10 + (str[i] - '0');
+					return "true";
 				}
 				else
 				{
-					fraction = fraction * 10 + (str[i] - '0');
-					decimal_power *= 10;
+					return "false";
 				}
 			}
-		}
-
-		double value = (double) whole;
-		value += (double) fraction / (double) decimal_power;
-
-		// std::cout << "float " << value << std::endl;
-
-		data = value;
-	}
-
-	llvm::ConstantData* FloatType::get_value(llvm::LLVMContext* llvm_context) const
-	{
-		if (this->type.get_size() == 32)
-		{
-			// create 32 bit floating point number
-			return llvm::ConstantFP::get(*llvm_context, llvm::APFloat((float) data));
-		}
-		else if (this->type.get_size() == 64)
-		{
-			// create 64 bit floating point number
-			return llvm::ConstantFP::get(*llvm_context, llvm::APFloat(data));
-		}
-	}
-
-	std::string FloatType::to_string() const
-	{
-		return std::to_string(this->data);
-	}
-
-	void FloatType::negate_value()
-	{
-		this->data = -data;
-	}
-
-	BoolType::BoolType()
-	{
-		this->data = false;
-	}
-
-	BoolType::BoolType(const std::string& str)
-	{
-		bool value = false;
-
-		if (str == "true")
-		{
-			value = true;
-		}
-		else if (str == "false")
-		{
-			value = false;
-		}
-
-		data = value;
-	}
-
-	llvm::ConstantData* BoolType::get_value(llvm::LLVMContext* llvm_context) const
-	{
-		if (data)
-		{
-			return llvm::ConstantInt::get(*llvm_context, llvm::APInt(1, 1, false));
-		}
-		else
-		{
-			return llvm::ConstantInt::get(*llvm_context, llvm::APInt(1, 0, false));
-		}
-	}
-
-	std::string BoolType::to_string() const
-	{
-		if (data)
-		{
-			return "true";
-		}
-		else
-		{
-			return "false";
-		}
-	}
-
-	CharType::CharType()
-	{
-		this->data = '\0';
-	}
-
-	CharType::CharType(const std::string& str)
-	{
-		char value;
-
-		if (str[1] != '\\')
-		{
-			value = str[1];
-		}
-		else
-		{
-			if (str[2] == '\'')
-			{
-				value = '\'';
-			}
-			else if (str[2] == '\"')
-			{
-				value = '"';
-			}
-			else if (str[2] == '\\')
-			{
-				value = '\\';
-			}
-			else if (str[2] == 'a')
-			{
-				value = '\a';
-			}
-			else if (str[2] == 'b')
-			{
-				value = '\b';
-			}
-			else if (str[2] == 'f')
-			{
-				value = '\f';
-			}
-			else if (str[2] == 'n')
-			{
-				value = '\n';
-			}
-			else if (str[2] == 'r')
-			{
-				value = '\r';
-			}
-			else if (str[2] == 't')
-			{
-				value = '\t';
-			}
-			else if (str[2] == 'v')
-			{
-				value = '\v';
-			}
-			else if (str[2] == '0')
+			case TypeEnum::Char:
 			{
-				value = '\0';
+				return std::string{value.char_value};
 			}
-			else
+			default:
 			{
-				value = str[2];
+				assert(false && "Invalid literal type");
+				return "";
 			}
 		}
-
-		data = value;
-	}
-
-	llvm::ConstantData* CharType::get_value(llvm::LLVMContext* llvm_context) const
-	{
-		return llvm::ConstantInt::get(*llvm_context, llvm::APInt(8, data, true));
-	}
-
-	std::string CharType::to_string() const
-	{
-		return std::string{data};
 	}
-
 }
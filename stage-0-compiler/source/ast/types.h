@@ -1,8 +1,11 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <memory>
+#include <vector>
 
 #include "llvm/IR/Constants.h"
 
@@ -11,7 +14,7 @@
 namespace types
 {
 	// the available supported native types
-	enum class TypeEnum
+	enum class TypeEnum : uint8_t
 	{
 		None,
 		Int, // 32-bit signed int
@@ -21,107 +24,122 @@ namespace types
 		Char, // 8-bit signed integer
 	};
 
+	// the kind, size and sign of a type, each different type is stored once in the type table
+	class TypeInfo
+	{
+	public:
+		TypeEnum type_enum;
+		bool signed_value;
+		uint16_t size;
+	};
+
+	// the primitive types are always in the type table, with these ids
+	inline constexpr TypeInfo primitive_types[] = {
+		{TypeEnum::None, false, 0},
+		{TypeEnum::Void, false, 0},
+		{TypeEnum::Bool, false, 1},
+		{TypeEnum::Char, true, 8},
+		{TypeEnum::Int, true, 8},
+		{TypeEnum::Int, true, 16},
+		{TypeEnum::Int, true, 32},
+		{TypeEnum::Int, true, 64},
+		{TypeEnum::Int, false, 8},
+		{TypeEnum::Int, false, 16},
+		{TypeEnum::Int, false, 32},
+		{TypeEnum::Int, false, 64},
+		{TypeEnum::Float, true, 32},
+		{TypeEnum::Float, true, 64},
+	};
+
+	inline constexpr int primitive_type_count = sizeof(primitive_types) / sizeof(TypeInfo);
+
+	// the type info of a type that is not a primitive type, the id must have come from a Type
+	const TypeInfo& get_type_info(int id);
+
+	// A handle to a type in the type table, so copying and comparing types only touches a single int.
+	// The ids are dense and start at 0, so they can index per type tables.
 	class Type
 	{
 	public:
 		Type();
 		explicit Type(TypeEnum type_enum);
 		Type(TypeEnum type_enum, int size, bool is_signed);
-		Type(const std::string& literal, TypeEnum type_enum);
-		bool operator==(const Type& other) const;
-		bool operator!=(const Type& other) const;
+		bool operator==(const Type& other) const { return this->id == other.id; }
+		bool operator!=(const Type& other) const { return this->id != other.id; }
 
-		TypeEnum get_type_enum() const { return this->type_enum; }
-		int get_size() const { return this->size; }
-		bool is_signed() const { return this->signed_value; }
+		int get_id() const { return this->id; }
+		TypeEnum get_type_enum() const { return this->get_info().type_enum; }
+		int get_size() const { return this->get_info().size; }
+		bool is_signed() const { return this->get_info().signed_value; }
 		std::string to_string() const;
 
 	private:
-		TypeEnum type_enum;
-		int size = 0;
-		bool signed_value = false;
-	};
+		const TypeInfo& get_info() const
+		{
+			return this->id < primitive_type_count ? primitive_types[this->id] : get_type_info(this->id);
+		}
 
-	Type is_valid_type(const std::string& str);
+	private:
+		// every ast node stores one, so it is kept to 4 bytes
+		int id;
+	};
 
-	std::pair<bool, Type> check_type_string(const std::string& str);
+	// the value of a literal, which member is used depends on the type of the literal
+	union LiteralValue
+	{
+		uint64_t int_value;
+		double float_value;
+		bool bool_value;
+		char char_value;
+	};
 
-	llvm::Type* get_llvm_type(llvm::LLVMContext& llvm_context, const Type& type);
+	// the type and value of a literal, both are found in a single pass over the literal string
+	class Literal
+	{
+	public:
+		Type type{TypeEnum::None};
+		LiteralValue value{0};
+		bool in_range = true;
+	};
 
-	llvm::Value* get_default_value(llvm::LLVMContext& llvm_context, const Type& type);
+	Type is_valid_type(std::string_view str);
 
-	bool check_range(const std::string& literal_string, const Type& type);
+	// the type is None if the string is not a valid literal
+	Literal check_type_string(std::string_view str);
 
-	bool is_cast_valid(const Type& from, const Type& target);
+	llvm::Type* get_llvm_type(llvm::LLVMContext& llvm_context, const Type& type);
 
-	bool is_numeric(TypeEnum type);
+	llvm::Value* get_default_value(llvm::LLVMContext& llvm_context, const Type& type);
 
-	class BaseType
+	// The llvm type and default value of each type, made once per llvm context and then looked up by type id
+	class LlvmTypeTable
 	{
-	protected:
-		Type type;
-
 	public:
-		virtual llvm::ConstantData* get_value(llvm::LLVMContext* llvm_context) const = 0;
-		virtual ~BaseType() = default;
-		virtual std::string to_string() const = 0;
-		virtual void negate_value();
+		explicit LlvmTypeTable(llvm::LLVMContext& llvm_context);
 
-	private:
-		virtual void set_type(const Type& type) final;
+		llvm::Type* get_llvm_type(const Type& type);
+		llvm::Value* get_default_value(const Type& type);
 
-	public:
-		static ptr_type<BaseType> create_type(const Type& curr_type, const std::string& str);
-		static bool is_digit(char c);
-	};
+	private:
+		class Entry
+		{
+		public:
+			llvm::Type* llvm_type = nullptr;
+			llvm::Value* default_value = nullptr;
+		};
 
-	class IntType : public BaseType
-	{
-	public:
-		IntType();
-		IntType(const std::string& str);
-		llvm::ConstantData* get_value(llvm::LLVMContext* llvm_context) const override;
-		std::string to_string() const override;
-		virtual void negate_value() override;
-		bool operator==(const IntType& other) const;
+		Entry& get_entry(const Type& type);
 
-	public:
-		static bool check_range(const std::string& literal_string);
 	private:
-		uint64_t data;
+		llvm::LLVMContext& llvm_context;
+		std::vector<Entry> entries;
 	};
 
-	class FloatType : public BaseType
-	{
-	public:
-		FloatType();
-		FloatType(const std::string& str);
-		llvm::ConstantData* get_value(llvm::LLVMContext* llvm_context) const override;
-		std::string to_string() const override;
-		virtual void negate_value() override;
-	private:
-		double data;
-	};
+	bool is_cast_valid(const Type& from, const Type& target);
 
-	class BoolType : public BaseType
-	{
-	public:
-		BoolType();
-		BoolType(const std::string& str);
-		llvm::ConstantData* get_value(llvm::LLVMContext* llvm_context) const override;
-		std::string to_string() const override;
-	private:
-		bool data;
-	};
+	bool is_numeric(TypeEnum type);
 
-	class CharType : public BaseType
-	{
-	public:
-		CharType();
-		CharType(const std::string& str);
-		llvm::ConstantData* get_value(llvm::LLVMContext* llvm_context) const override;
-		std::string to_string() const override;
-	private:
-		char data;
-	};
+	llvm::Constant* get_literal_constant(llvm::LLVMContext& llvm_context, const Type& type, const LiteralValue& value);
+
+	std::string literal_to_string(const Type& type, const LiteralValue& value);
 };
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <cassert>
+
+#include "ast.h"
+
+namespace ast
+{
+	// The AstExprType of each node class
+	template<class T>
+	struct expr_type_of;
+
+	template<>
+	struct expr_type_of<LiteralExpr>
+	{
+		static constexpr AstExprType value = AstExprType::LiteralExpr;
+	};
+
+	template<>
+	struct expr_type_of<BodyExpr>
+	{
+		static constexpr AstExprType value = AstExprType::BodyExpr;
+	};
+
+	template<>
+	struct expr_type_of<VariableDeclarationExpr>
+	{
+		static constexpr AstExprType value = AstExprType::VariableDeclarationExpr;
+	};
+
+	template<>
+	struct expr_type_of<VariableReferenceExpr>
+	{
+		static constexpr AstExprType value = AstExprType::VariableReferenceExpr;
+	};
+
+	template<>
+	struct expr_type_of<BinaryExpr>
+	{
+		static constexpr AstExprType value = AstExprType::BinaryExpr;
+	};
+
+	template<>
+	struct expr_type_of<CallExpr>
+	{
+		static constexpr AstExprType value = AstExprType::CallExpr;
+	};
+
+	template<>
+	struct expr_type_of<IfExpr>
+	{
+		static constexpr AstExprType value = AstExprType::IfExpr;
+	};
+
+	template<>
+	struct expr_type_of<ForExpr>
+	{
+		static constexpr AstExprType value = AstExprType::ForExpr;
+	};
+
+	template<>
+	struct expr_type_of<WhileExpr>
+	{
+		static constexpr AstExprType value = AstExprType::WhileExpr;
+	};
+
+	template<>
+	struct expr_type_of<CommentExpr>
+	{
+		static constexpr AstExprType value = AstExprType::CommentExpr;
+	};
+
+	template<>
+	struct expr_type_of<ReturnExpr>
+	{
+		static constexpr AstExprType value = AstExprType::ReturnExpr;
+	};
+
+	template<>
+	struct expr_type_of<ContinueExpr>
+	{
+		static constexpr AstExprType value = AstExprType::ContinueExpr;
+	};
+
+	template<>
+	struct expr_type_of<BreakExpr>
+	{
+		static constexpr AstExprType value = AstExprType::BreakExpr;
+	};
+
+	template<>
+	struct expr_type_of<UnaryExpr>
+	{
+		static constexpr AstExprType value = AstExprType::UnaryExpr;
+	};
+
+	template<>
+	struct expr_type_of<CastExpr>
+	{
+		static constexpr AstExprType value = AstExprType::CastExpr;
+	};
+
+	template<>
+	struct expr_type_of<SwitchExpr>
+	{
+		static constexpr AstExprType value = AstExprType::SwitchExpr;
+	};
+
+	template<>
+	struct expr_type_of<CaseExpr>
+	{
+		static constexpr AstExprType value = AstExprType::CaseExpr;
+	};
+
+	// Casts to a node class without rtti, the expr must be of that type
+	template<class T>
+	T* expr_cast(BaseExpr* expr)
+	{
+		assert(expr->get_type() == expr_type_of<T>::value && "Invalid Expr Cast");
+		return static_cast<T*>(expr);
+	}
+
+	template<class T>
+	const T* expr_cast(const BaseExpr* expr)
+	{
+		assert(expr->get_type() == expr_type_of<T>::value && "Invalid Expr Cast");
+		return static_cast<const T*>(expr);
+	}
+
+	// Casts to a node class without rtti, returns nullptr if the expr is not of that type
+	template<class T>
+	T* dyn_expr_cast(BaseExpr* expr)
+	{
+		if (expr->get_type() != expr_type_of<T>::value)
+		{
+			return nullptr;
+		}
+		return static_cast<T*>(expr);
+	}
+
+	template<class T>
+	const T* dyn_expr_cast(const BaseExpr* expr)
+	{
+		if (expr->get_type() != expr_type_of<T>::value)
+		{
+			return nullptr;
+		}
+		return static_cast<const T*>(expr);
+	}
+
+	// Calls the visitor with the expr cast to its node class,
+	// each pass walks the tree by calling this from the visitor for the child nodes.
+	// The visitor must return the same type for every node class.
+	template<class Visitor>
+	auto visit(BaseExpr* expr, Visitor&& visitor)
+	{
+		using Result = decltype(visitor(static_cast<LiteralExpr*>(expr)));
+
+		switch (expr->get_type())
+		{
+			case AstExprType::LiteralExpr:
+			{
+				return visitor(static_cast<LiteralExpr*>(expr));
+			}
+			case AstExprType::BodyExpr:
+			{
+				return visitor(static_cast<BodyExpr*>(expr));
+			}
+			case AstExprType::VariableDeclarationExpr:
+			{
+				return visitor(static_cast<VariableDeclarationExpr*>(expr));
+			}
+			case AstExprType::VariableReferenceExpr:
+			{
+				return visitor(static_cast<VariableReferenceExpr*>(expr));
+			}
+			case AstExprType::BinaryExpr:
+			{
+				return visitor(static_cast<BinaryExpr*>(expr));
+			}
+			case AstExprType::CallExpr:
+			{
+				return visitor(static_cast<CallExpr*>(expr));
+			}
+			case AstExprType::IfExpr:
+			{
+				return visitor(static_cast<IfExpr*>(expr));
+			}
+			case AstExprType::ForExpr:
+			{
+				return visitor(static_cast<ForExpr*>(expr));
+			}
+			case AstExprType::WhileExpr:
+			{
+				return visitor(static_cast<WhileExpr*>(expr));
+			}
+			case AstExprType::CommentExpr:
+			{
+				return visitor(static_cast<CommentExpr*>(expr));
+			}
+			case AstExprType::ReturnExpr:
+			{
+				return visitor(static_cast<ReturnExpr*>(expr));
+			}
+			case AstExprType::ContinueExpr:
+			{
+				return visitor(static_cast<ContinueExpr*>(expr));
+			}
+			case AstExprType::BreakExpr:
+			{
+				return visitor(static_cast<BreakExpr*>(expr));
+			}
+			case AstExprType::UnaryExpr:
+			{
+				return visitor(static_cast<UnaryExpr*>(expr));
+			}
+			case AstExprType::CastExpr:
+			{
+				return visitor(static_cast<CastExpr*>(expr));
+			}
+			case AstExprType::SwitchExpr:
+			{
+				return visitor(static_cast<SwitchExpr*>(expr));
+			}
+			case AstExprType::CaseExpr:
+			{
+				return visitor(static_cast<CaseExpr*>(expr));
+			}
+			case AstExprType::BaseExpr:
+			{
+				break;
+			}
+		}
+		assert(false && "Missing Type Specialisation");
+		return Result();
+	}
+}
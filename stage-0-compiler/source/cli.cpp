@@ -1,13 +1,30 @@
 #include "cli.h"
 
-#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
 #include <iostream>
-
+#include <thread>
+
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/CodeGen/ParallelCG.h"
+#include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/ExecutionEngine/Orc/TargetProcess/TargetExecutionUtils.h"
 #include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Linker/Linker.h"
+#include "llvm/MC/SubtargetFeature.h"
+#include "llvm/Passes/PassBuilder.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 
+#include "ast/ast_arena.h"
 #include "ast/constant_checker.h"
+#include "ast/constant_folder.h"
 #include "ast/parser.h"
+#include "ast/source_manager.h"
 #include "ast/string_manager.h"
 #include "ast/type_checker.h"
 #include "cli_parser.h"
@@ -21,15 +38,24 @@ namespace cli
 
 		// argv[0] is file name
 		// argv[1] is input file
-		// argv[2] is output file
+		// argv[2] is output file, which isn't needed when the program is run
+
+		// --run [args]
+		this->run_enabled = cliData.hasOptionFlag("run");
+		this->run_arguments = cliData.run_arguments;
+
+		size_t required_values = this->run_enabled ? 1 : 2;
 
-		if (!cliData.valid || cliData.values.size() < 2)
+		if (!cliData.valid || cliData.values.size() < required_values)
 		{
-			if (cliData.values.size() < 2)
+			if (cliData.values.empty())
 			{
 				std::cout << "No input file specified." << std::endl;
 			}
-			std::cout << "No ouput file specified." << std::endl;
+			if (!this->run_enabled)
+			{
+				std::cout << "No ouput file specified." << std::endl;
+			}
 
 			std::cout << "Usage: ";
 
@@ -40,7 +66,7 @@ namespace cli
 			std::cout << "./ash-boot-stage0";
 #endif
 
-			std::cout << " input-file output-file" << std::endl;
+			std::cout << " input-file output-file, or input-file --run [args]" << std::endl;
 			return;
 		}
 
@@ -63,8 +89,11 @@ namespace cli
 
 		input_files.push_back(input_file_path);
 
-		std::filesystem::path output_file_path{cliData.values[1]};
-		output_file = output_file_path;
+		if (!this->run_enabled)
+		{
+			std::filesystem::path output_file_path{cliData.values[1]};
+			output_file = output_file_path;
+		}
 
 		// --output-type=[ir|obj]
 		if (cliData.hasOptionValue("output-type"))
@@ -87,10 +116,13 @@ namespace cli
 			}
 		}
 
-		// --input=filename
-		if (cliData.hasOptionValue("input"))
+		// --input=filename, can be given more than once
+		for (auto& [key, option] : cliData.value_options)
 		{
-			auto& option = cliData.getOptionValue("input");
+			if (key != "input")
+			{
+				continue;
+			}
 
 			std::filesystem::path input_file_path{option};
 
@@ -153,9 +185,189 @@ namespace cli
 			}
 		}
 
+		// --opt-level=[0|1|2|3|s|z]
+		if (cliData.hasOptionValue("opt-level"))
+		{
+			auto& option = cliData.getOptionValue("opt-level");
+
+			if (option == "0")
+			{
+				this->optimisation_level = OptimisationLevel::O0;
+			}
+			else if (option == "1")
+			{
+				this->optimisation_level = OptimisationLevel::O1;
+			}
+			else if (option == "2")
+			{
+				this->optimisation_level = OptimisationLevel::O2;
+			}
+			else if (option == "3")
+			{
+				this->optimisation_level = OptimisationLevel::O3;
+			}
+			else if (option == "s")
+			{
+				this->optimisation_level = OptimisationLevel::Os;
+			}
+			else if (option == "z")
+			{
+				this->optimisation_level = OptimisationLevel::Oz;
+			}
+			else
+			{
+				std::cout << "Invalid value for --opt-level option: " << option << std::endl;
+				std::cout << "Valid values are: 0, 1, 2, 3, s or z" << std::endl;
+				return;
+			}
+		}
+
+		// --target-cpu=[cpu|native]
+		if (cliData.hasOptionValue("target-cpu"))
+		{
+			auto& option = cliData.getOptionValue("target-cpu");
+
+			if (option.empty())
+			{
+				std::cout << "Invalid value for --target-cpu option: " << option << std::endl;
+				std::cout << "Valid values are: a cpu name, or native" << std::endl;
+				return;
+			}
+
+			this->target_config.cpu = option;
+		}
+
+		// --target-features=[+feature,-feature,...]
+		if (cliData.hasOptionValue("target-features"))
+		{
+			this->target_config.features = cliData.getOptionValue("target-features");
+		}
+
+		// --reloc-model=[static|pic|dynamic-no-pic]
+		if (cliData.hasOptionValue("reloc-model"))
+		{
+			auto& option = cliData.getOptionValue("reloc-model");
+
+			if (option == "static")
+			{
+				this->target_config.reloc_model = llvm::Reloc::Static;
+			}
+			else if (option == "pic")
+			{
+				this->target_config.reloc_model = llvm::Reloc::PIC_;
+			}
+			else if (option == "dynamic-no-pic")
+			{
+				this->target_config.reloc_model = llvm::Reloc::DynamicNoPIC;
+			}
+			else
+			{
+				std::cout << "Invalid value for --reloc-model option: " << option << std::endl;
+				std::cout << "Valid values are: static, pic or dynamic-no-pic" << std::endl;
+				return;
+			}
+		}
+
+		// --code-model=[tiny|small|kernel|medium|large]
+		if (cliData.hasOptionValue("code-model"))
+		{
+			auto& option = cliData.getOptionValue("code-model");
+
+			if (option == "tiny")
+			{
+				this->target_config.code_model = llvm::CodeModel::Tiny;
+			}
+			else if (option == "small")
+			{
+				this->target_config.code_model = llvm::CodeModel::Small;
+			}
+			else if (option == "kernel")
+			{
+				this->target_config.code_model = llvm::CodeModel::Kernel;
+			}
+			else if (option == "medium")
+			{
+				this->target_config.code_model = llvm::CodeModel::Medium;
+			}
+			else if (option == "large")
+			{
+				this->target_config.code_model = llvm::CodeModel::Large;
+			}
+			else
+			{
+				std::cout << "Invalid value for --code-model option: " << option << std::endl;
+				std::cout << "Valid values are: tiny, small, kernel, medium or large" << std::endl;
+				return;
+			}
+		}
+
+		// --build-threads=[count]
+		if (cliData.hasOptionValue("build-threads"))
+		{
+			auto& option = cliData.getOptionValue("build-threads");
+
+			unsigned int build_threads = 0;
+			auto [end, error] = std::from_chars(option.data(), option.data() + option.size(), build_threads);
+
+			if (error != std::errc{} || end != option.data() + option.size() || build_threads == 0)
+			{
+				std::cout << "Invalid value for --build-threads option: " << option << std::endl;
+				std::cout << "Valid values are: a number greater than 0" << std::endl;
+				return;
+			}
+
+			this->build_threads = build_threads;
+		}
+
+		// --codegen-threads=[count]
+		if (cliData.hasOptionValue("codegen-threads"))
+		{
+			auto& option = cliData.getOptionValue("codegen-threads");
+
+			unsigned int codegen_threads = 0;
+			auto [end, error] = std::from_chars(option.data(), option.data() + option.size(), codegen_threads);
+
+			if (error != std::errc{} || end != option.data() + option.size() || codegen_threads == 0)
+			{
+				std::cout << "Invalid value for --codegen-threads option: " << option << std::endl;
+				std::cout << "Valid values are: a number greater than 0" << std::endl;
+				return;
+			}
+
+			this->codegen_threads = codegen_threads;
+		}
+
+		// --skip-teardown=[true|false]
+		if (cliData.hasOptionValue("skip-teardown"))
+		{
+			auto& option = cliData.getOptionValue("skip-teardown");
+
+			if (option == "true")
+			{
+				this->skip_teardown = true;
+			}
+			else if (option == "false")
+			{
+				this->skip_teardown = false;
+			}
+			else
+			{
+				std::cout << "Invalid value for --skip-teardown option: " << option << std::endl;
+				std::cout << "Valid values are: true or false" << std::endl;
+				return;
+			}
+		}
+
 		parsed = true;
 	}
 
+	CLI::~CLI()
+	{
+		// the asts have to be destroyed before the arena they are stored in is released
+		moduleManager::clear_asts();
+		astArena::release();
+	}
+
 	bool CLI::run()
 	{
 		if (!parsed)
@@ -183,6 +395,11 @@ namespace cli
 			return false;
 		}
 
+		if (!this->fold_constants())
+		{
+			return false;
+		}
+
 		if (this->json_output_enabled)
 		{
 			if (!this->ouput_json())
@@ -196,6 +413,16 @@ namespace cli
 			return false;
 		}
 
+		if (!optimise_module())
+		{
+			return false;
+		}
+
+		if (this->run_enabled)
+		{
+			return run_program();
+		}
+
 		switch (output_type)
 		{
 			case OutputType::IR:
@@ -219,29 +446,39 @@ namespace cli
 		return true;
 	}
 
+	bool CLI::should_skip_teardown() const
+	{
+		return this->skip_teardown;
+	}
+
+	int CLI::get_exit_code() const
+	{
+		return this->exit_code;
+	}
+
 	bool CLI::parse_file()
 	{
 		for (auto& file : input_files)
 		{
-			// open the input file stream
-			// TODO: use llvm MemoryBuffer or SourceManager
-			std::ifstream file_stream;
+			// map the whole file into memory, so the parser can work on a single contiguous buffer
+			llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> file_buffer = llvm::MemoryBuffer::getFile(file.string());
 
-			file_stream.open(file);
-
-			if (!file_stream.is_open())
+			if (!file_buffer)
 			{
-				std::cout << "File: \"" << file.string() << "\" could not be opened." << std::endl;
+				std::cout << "File: \"" << file.string() << "\" could not be opened: " << file_buffer.getError().message()
+						  << std::endl;
 				return false;
 			}
 
+			// the source manager keeps the buffer alive, so errors found after parsing can still show the source line
+			int file_id = moduleManager::get_file_as_module(file.string());
+			sourceManager::add_file(file_id, std::move(file_buffer.get()));
+
 			// parse the file
-			parser::Parser parser{file_stream, file.string()};
+			parser::Parser parser{sourceManager::get_buffer(file_id), file.string()};
 			ptr_type<ast::BodyExpr> body_ast = std::move(parser.parse_file_as_body());
 			current_module = parser.get_module();
 
-			file_stream.close();
-
 			if (body_ast == nullptr)
 			{
 				std::cout << std::endl;
@@ -295,6 +532,9 @@ namespace cli
 			}
 		}
 
+		// every file has exported its functions, so the calls between files can be resolved
+		moduleManager::build_import_index();
+
 		for (auto& f : build_files_order)
 		{
 			// do type checking
@@ -331,6 +571,17 @@ namespace cli
 		return true;
 	}
 
+	bool CLI::fold_constants()
+	{
+		// the folder needs the types and constant status from the checks, so it runs after them
+		for (auto& f : build_files_order)
+		{
+			constant_folder::fold_body(moduleManager::get_ast(f));
+		}
+
+		return true;
+	}
+
 	bool CLI::ouput_json()
 	{
 		json::JsonArray root{};
@@ -361,14 +612,138 @@ namespace cli
 
 	bool CLI::build_ast()
 	{
-		if (!llvm_builder.set_target())
+		if (!llvm_builder.set_target(this->target_config))
 		{
 			std::cout << "Failed to set target" << std::endl;
 			return false;
 		}
 
+		if (this->build_threads > 1 && build_files_order.size() > 1)
+		{
+			return build_ast_parallel();
+		}
+
 		// llvm_builder.llvm_module->setSourceFileName(input_files[0].string());
 
+		if (!generate_code(llvm_builder, build_files_order))
+		{
+			return false;
+		}
+
+		std::cout << "Successfully Generated LLVM IR Code" << std::endl;
+
+		return true;
+	}
+
+	bool CLI::build_ast_parallel()
+	{
+		enum class FileState
+		{
+			Failed,
+			Built,
+			Invalid,
+		};
+
+		// each file is built into its own context, then they are moved into the main context as bitcode and linked
+		std::vector<llvm::SmallVector<char, 0>> file_bitcode(build_files_order.size());
+		std::vector<FileState> file_states(build_files_order.size(), FileState::Failed);
+		std::atomic<size_t> next_file = 0;
+
+		auto build_files = [&]()
+		{
+			for (size_t i = next_file++; i < build_files_order.size(); i = next_file++)
+			{
+				builder::LLVMBuilder file_builder;
+
+				if (!file_builder.set_target(this->target_config) ||
+					!generate_code(file_builder, {build_files_order[i]}))
+				{
+					continue;
+				}
+
+				// bitcode can only hold valid ir, so an invalid file is left for the single threaded build
+				if (llvm::verifyModule(*file_builder.llvm_module))
+				{
+					file_states[i] = FileState::Invalid;
+					continue;
+				}
+
+				std::string verify_errors;
+				optimise_builder(file_builder, verify_errors);
+
+				llvm::raw_svector_ostream bitcode_stream(file_bitcode[i]);
+				llvm::WriteBitcodeToFile(*file_builder.llvm_module, bitcode_stream);
+
+				file_states[i] = FileState::Built;
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for (unsigned int i = 0; i < this->build_threads && i < build_files_order.size(); i++)
+		{
+			threads.emplace_back(build_files);
+		}
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+
+		if (std::find(file_states.begin(), file_states.end(), FileState::Failed) != file_states.end())
+		{
+			return false;
+		}
+
+		if (std::find(file_states.begin(), file_states.end(), FileState::Invalid) != file_states.end())
+		{
+			std::cout << "LLVM IR Failed Verification, Building The Files On One Thread" << std::endl;
+
+			if (!generate_code(llvm_builder, build_files_order))
+			{
+				return false;
+			}
+
+			std::cout << "Successfully Generated LLVM IR Code" << std::endl;
+
+			return true;
+		}
+
+		std::cout << "Successfully Generated LLVM IR Code" << std::endl;
+
+		llvm::Linker linker(*llvm_builder.llvm_module);
+
+		for (size_t i = 0; i < build_files_order.size(); i++)
+		{
+			llvm::MemoryBufferRef bitcode_buffer(
+				llvm::StringRef(file_bitcode[i].data(), file_bitcode[i].size()),
+				stringManager::get_string(build_files_order[i]));
+
+			llvm::Expected<std::unique_ptr<llvm::Module>> file_module =
+				llvm::parseBitcodeFile(bitcode_buffer, *llvm_builder.llvm_context);
+
+			if (!file_module)
+			{
+				std::cout << "Failed To Read LLVM Bitcode: " << llvm::toString(file_module.takeError()) << std::endl;
+				return false;
+			}
+
+			// the calls to functions in other files are declarations, which link to the definitions
+			if (linker.linkInModule(std::move(*file_module)))
+			{
+				std::cout << "Failed To Link LLVM Module: " << stringManager::get_string(build_files_order[i])
+						  << std::endl;
+				return false;
+			}
+		}
+
+		this->built_in_parallel = true;
+
+		return true;
+	}
+
+	bool CLI::generate_code(builder::LLVMBuilder& builder, const std::vector<int>& definition_files) const
+	{
+		// every file's prototypes are generated, so calls into the other files are declarations
 		for (auto& f : build_files_order)
 		{
 			ast::BodyExpr* body_ast = moduleManager::get_ast(f);
@@ -376,7 +751,7 @@ namespace cli
 			// generate all of the function prototypes
 			for (auto& p : body_ast->function_prototypes)
 			{
-				auto proto = llvm_builder.generate_function_prototype(p.second);
+				auto proto = builder.generate_function_prototype(p.second);
 
 				if (proto == nullptr)
 				{
@@ -388,14 +763,14 @@ namespace cli
 			}
 		}
 
-		for (auto& f : build_files_order)
+		for (auto& f : definition_files)
 		{
 			ast::BodyExpr* body_ast = moduleManager::get_ast(f);
 
 			// generate all of the top level functions
 			for (auto& f : body_ast->functions)
 			{
-				auto func = llvm_builder.generate_function_definition(f.get());
+				auto func = builder.generate_function_definition(f.get());
 
 				if (func == nullptr)
 				{
@@ -407,11 +782,139 @@ namespace cli
 			}
 		}
 
-		std::cout << "Successfully Generated LLVM IR Code" << std::endl;
+		return true;
+	}
+
+	bool CLI::optimise_module()
+	{
+		if (this->optimisation_level == OptimisationLevel::O0)
+		{
+			// the module is output as it was built
+			return true;
+		}
+
+		if (this->built_in_parallel)
+		{
+			// each file was optimised on the thread that built it, so only the codegen level is left to set
+			llvm::OptimizationLevel pipeline_level = llvm::OptimizationLevel::O0;
+			llvm::CodeGenOpt::Level codegen_level = llvm::CodeGenOpt::None;
+			get_optimisation_levels(pipeline_level, codegen_level);
+
+			llvm_builder.target_machine->setOptLevel(codegen_level);
+			return true;
+		}
+
+		std::string verify_errors;
+
+		if (!optimise_builder(llvm_builder, verify_errors))
+		{
+			std::cout << "LLVM IR Failed Verification, Skipping Optimisation" << std::endl;
+			std::cout << verify_errors;
+			return true;
+		}
+
+		std::cout << "Successfully Optimised LLVM IR Code" << std::endl;
 
 		return true;
 	}
 
+	bool CLI::optimise_builder(builder::LLVMBuilder& builder, std::string& verify_errors) const
+	{
+		llvm::OptimizationLevel pipeline_level = llvm::OptimizationLevel::O0;
+		llvm::CodeGenOpt::Level codegen_level = llvm::CodeGenOpt::None;
+
+		if (!get_optimisation_levels(pipeline_level, codegen_level))
+		{
+			return true;
+		}
+
+		// the passes expect valid ir, so a module that fails verification is output without optimising it
+		llvm::raw_string_ostream verify_stream(verify_errors);
+
+		if (llvm::verifyModule(*builder.llvm_module, &verify_stream))
+		{
+			verify_stream.flush();
+			return false;
+		}
+
+		builder.target_machine->setOptLevel(codegen_level);
+
+		// the analysis managers must be declared in this order, so they are destroyed in the reverse order
+		llvm::LoopAnalysisManager loop_analysis_manager;
+		llvm::FunctionAnalysisManager function_analysis_manager;
+		llvm::CGSCCAnalysisManager cgscc_analysis_manager;
+		llvm::ModuleAnalysisManager module_analysis_manager;
+
+		// the vectorisers are off by default, so they are turned on for the levels that optimise for speed, like clang
+		llvm::PipelineTuningOptions tuning_options;
+		tuning_options.LoopVectorization = pipeline_level.getSpeedupLevel() > 1 && pipeline_level.getSizeLevel() < 2;
+		tuning_options.SLPVectorization = pipeline_level.getSpeedupLevel() > 1 && pipeline_level.getSizeLevel() < 2;
+
+		// the target machine gives the passes the target cost model, which the vectorisers and inliner use
+		llvm::PassBuilder pass_builder(builder.target_machine, tuning_options);
+
+		pass_builder.registerModuleAnalyses(module_analysis_manager);
+		pass_builder.registerCGSCCAnalyses(cgscc_analysis_manager);
+		pass_builder.registerFunctionAnalyses(function_analysis_manager);
+		pass_builder.registerLoopAnalyses(loop_analysis_manager);
+		pass_builder.crossRegisterProxies(
+			loop_analysis_manager,
+			function_analysis_manager,
+			cgscc_analysis_manager,
+			module_analysis_manager);
+
+		// the default pipeline includes mem2reg, instcombine, gvn, inlining, the loop passes and the vectorisers
+		llvm::ModulePassManager module_pass_manager = pass_builder.buildPerModuleDefaultPipeline(pipeline_level);
+
+		module_pass_manager.run(*builder.llvm_module, module_analysis_manager);
+
+		return true;
+	}
+
+	bool CLI::get_optimisation_levels(
+		llvm::OptimizationLevel& pipeline_level,
+		llvm::CodeGenOpt::Level& codegen_level) const
+	{
+		switch (this->optimisation_level)
+		{
+			case OptimisationLevel::O0:
+			{
+				return false;
+			}
+			case OptimisationLevel::O1:
+			{
+				pipeline_level = llvm::OptimizationLevel::O1;
+				codegen_level = llvm::CodeGenOpt::Less;
+				return true;
+			}
+			case OptimisationLevel::O2:
+			{
+				pipeline_level = llvm::OptimizationLevel::O2;
+				codegen_level = llvm::CodeGenOpt::Default;
+				return true;
+			}
+			case OptimisationLevel::O3:
+			{
+				pipeline_level = llvm::OptimizationLevel::O3;
+				codegen_level = llvm::CodeGenOpt::Aggressive;
+				return true;
+			}
+			case OptimisationLevel::Os:
+			{
+				pipeline_level = llvm::OptimizationLevel::Os;
+				codegen_level = llvm::CodeGenOpt::Default;
+				return true;
+			}
+			case OptimisationLevel::Oz:
+			{
+				pipeline_level = llvm::OptimizationLevel::Oz;
+				codegen_level = llvm::CodeGenOpt::Default;
+				return true;
+			}
+		}
+		return false;
+	}
+
 	bool CLI::output_llvm_ir()
 	{
 		std::error_code error_code;
@@ -444,6 +947,17 @@ namespace cli
 
 	bool CLI::output_object_file()
 	{
+		if (this->codegen_threads > 1)
+		{
+			// the partitions are passed to their threads as bitcode, which can only hold valid ir
+			if (!llvm::verifyModule(*llvm_builder.llvm_module))
+			{
+				return output_object_files_parallel();
+			}
+
+			std::cout << "LLVM IR Failed Verification, Emitting The Object Code On One Thread" << std::endl;
+		}
+
 		std::error_code error_code;
 
 		// create the raw fd stream
@@ -481,4 +995,154 @@ namespace cli
 		return true;
 	}
 
+	bool CLI::output_object_files_parallel()
+	{
+		// the first partition is written to the output file, the others to files numbered after it
+		std::vector<std::filesystem::path> partition_files;
+		std::vector<std::unique_ptr<llvm::raw_fd_ostream>> partition_streams;
+		std::vector<llvm::raw_pwrite_stream*> partition_stream_ptrs;
+
+		for (unsigned int i = 0; i < this->codegen_threads; i++)
+		{
+			std::filesystem::path partition_file = output_file;
+			if (i > 0)
+			{
+				partition_file.replace_filename(
+					output_file.stem().string() + "." + std::to_string(i) + output_file.extension().string());
+			}
+
+			std::error_code error_code;
+
+			// create the raw fd stream
+			auto output_file_stream = std::make_unique<llvm::raw_fd_ostream>(
+				partition_file.string(),
+				error_code,
+				llvm::sys::fs::CreationDisposition::CD_CreateAlways,
+				llvm::sys::fs::FileAccess::FA_Write,
+				llvm::sys::fs::OpenFlags::OF_None);
+
+			if (error_code)
+			{
+				// error
+				std::cout << "Error Opening Output File Stream: " << error_code.message() << std::endl;
+				return false;
+			}
+
+			partition_files.push_back(partition_file);
+			partition_stream_ptrs.push_back(output_file_stream.get());
+			partition_streams.push_back(std::move(output_file_stream));
+		}
+
+		// splits the module by function, and runs the backend for each partition on its own thread,
+		// each thread needs its own target machine
+		llvm::splitCodeGen(
+			*llvm_builder.llvm_module,
+			partition_stream_ptrs,
+			{},
+			[this]() { return llvm_builder.create_target_machine(); },
+			llvm::CodeGenFileType::CGFT_ObjectFile);
+
+		// close file streams
+		for (auto& output_file_stream : partition_streams)
+		{
+			output_file_stream->flush();
+			output_file_stream->close();
+		}
+
+		std::cout << "Object Code Was Successfully Written To Files:";
+		for (auto& partition_file : partition_files)
+		{
+			std::cout << " " << partition_file.string();
+		}
+		std::cout << std::endl;
+
+		return true;
+	}
+
+	bool CLI::run_program()
+	{
+		// the functions are split out of the module, and compiled the first time they are called,
+		// which needs valid ir, otherwise the whole module is compiled before main is run
+		bool compile_lazily = !llvm::verifyModule(*llvm_builder.llvm_module);
+
+		if (!compile_lazily)
+		{
+			std::cout << "LLVM IR Failed Verification, Compiling The Whole Module Before Running It" << std::endl;
+		}
+
+		// the jit compiles for the same target as the object files
+		llvm::TargetMachine* target_machine = llvm_builder.target_machine;
+
+		llvm::orc::JITTargetMachineBuilder machine_builder{target_machine->getTargetTriple()};
+		machine_builder.setCPU(target_machine->getTargetCPU().str());
+		machine_builder.getFeatures() = llvm::SubtargetFeatures(target_machine->getTargetFeatureString());
+		machine_builder.setCodeGenOptLevel(target_machine->getOptLevel());
+
+		if (target_config.reloc_model.has_value())
+		{
+			machine_builder.setRelocationModel(*target_config.reloc_model);
+		}
+
+		if (target_config.code_model.has_value())
+		{
+			machine_builder.setCodeModel(*target_config.code_model);
+		}
+
+		auto jit = llvm::orc::LLLazyJITBuilder().setJITTargetMachineBuilder(std::move(machine_builder)).create();
+
+		if (!jit)
+		{
+			std::cout << "Failed To Create The JIT: " << llvm::toString(jit.takeError()) << std::endl;
+			return false;
+		}
+
+		// extern functions are looked up in the symbols of this process, which includes the c library
+		auto process_symbols = llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+			(*jit)->getDataLayout().getGlobalPrefix());
+
+		if (!process_symbols)
+		{
+			std::cout << "Failed To Load The Process Symbols: " << llvm::toString(process_symbols.takeError())
+					  << std::endl;
+			return false;
+		}
+
+		(*jit)->getMainJITDylib().addGenerator(std::move(*process_symbols));
+
+		// the jit takes ownership of the module and its context, so the builder mustn't delete them
+		llvm::orc::ThreadSafeModule module{
+			std::unique_ptr<llvm::Module>(llvm_builder.llvm_module),
+			std::unique_ptr<llvm::LLVMContext>(llvm_builder.llvm_context)};
+		llvm_builder.llvm_module = nullptr;
+		llvm_builder.llvm_context = nullptr;
+
+		llvm::Error add_error
+			= compile_lazily ? (*jit)->addLazyIRModule(std::move(module)) : (*jit)->addIRModule(std::move(module));
+
+		if (add_error)
+		{
+			std::cout << "Failed To Add The Module To The JIT: " << llvm::toString(std::move(add_error)) << std::endl;
+			return false;
+		}
+
+		auto main_symbol = (*jit)->lookup("main");
+
+		if (!main_symbol)
+		{
+			std::cout << "Failed To Find The main Function: " << llvm::toString(main_symbol.takeError()) << std::endl;
+			return false;
+		}
+
+		using MainFunction = int (*)(int, char**);
+		auto main_function = main_symbol->toPtr<MainFunction>();
+
+		std::cout << "Running The Program" << std::endl;
+
+		// argv[0] is the input file, followed by the arguments given after --run
+		std::string program_name = input_files.front().string();
+		this->exit_code = llvm::orc::runAsMain(main_function, this->run_arguments, llvm::StringRef(program_name));
+
+		return true;
+	}
+
 }
@@ -2,6 +2,11 @@
 
 #include <filesystem>
 #include <memory>
+#include <string>
+#include <vector>
+
+#include "llvm/Passes/OptimizationLevel.h"
+#include "llvm/Support/CodeGen.h"
 
 #include "ast/ast.h"
 #include "ast/builder.h"
@@ -17,20 +22,46 @@ namespace cli
 			OBJ,
 		};
 
+		enum class OptimisationLevel
+		{
+			O0,
+			O1,
+			O2,
+			O3,
+			Os,
+			Oz,
+		};
+
 	public:
 		CLI(int argc, char** argv);
+		~CLI();
 
 		bool run();
+		bool should_skip_teardown() const;
+		// the exit code of the program's main function, when it was run
+		int get_exit_code() const;
 
 	private:
 		bool parse_file();
 		bool check_modules();
 		bool check_ast();
 		bool extra_checks();
+		bool fold_constants();
 		bool ouput_json();
 		bool build_ast();
+		bool build_ast_parallel();
+		bool generate_code(builder::LLVMBuilder& builder, const std::vector<int>& definition_files) const;
+		bool optimise_module();
+		// returns false if the module failed verification, and was left unoptimised
+		bool optimise_builder(builder::LLVMBuilder& builder, std::string& verify_errors) const;
+		// returns false for O0, which doesn't run any passes
+		bool get_optimisation_levels(
+			llvm::OptimizationLevel& pipeline_level,
+			llvm::CodeGenOpt::Level& codegen_level) const;
 		bool output_llvm_ir();
 		bool output_object_file();
+		bool output_object_files_parallel();
+		bool run_program();
 
 	private:
 		bool parsed = false;
@@ -38,10 +69,24 @@ namespace cli
 		std::filesystem::path output_file;
 		builder::LLVMBuilder llvm_builder;
 		OutputType output_type = OutputType::IR;
+		OptimisationLevel optimisation_level = OptimisationLevel::O0;
+		builder::TargetConfig target_config;
+		// the files are built on this many threads, each into its own llvm context, when there is more than one
+		unsigned int build_threads = 1;
+		// set once the files have been built on their own threads and linked, they are already optimised
+		bool built_in_parallel = false;
+		// the object file is split into this many partitions, which are emitted on their own threads
+		unsigned int codegen_threads = 1;
+		// the module is compiled by the jit and its main function is run, instead of writing an output file
+		bool run_enabled = false;
+		std::vector<std::string> run_arguments;
+		int exit_code = 0;
 		int current_module;
 		std::vector<int> build_files_order;
 
 		bool json_output_enabled = false;
 		bool json_ouput_minified = false;
+
+		bool skip_teardown = false;
 	};
 }
@@ -16,6 +16,13 @@ namespace cliParser
 		{
 			auto& arg = arguments.at(i);
 
+			if (arg == "--run")
+			{
+				data.flag_options.push_back("run");
+				data.run_arguments.assign(arguments.begin() + i + 1, arguments.end());
+				break;
+			}
+
 			if (arg.find("--") == 0)
 			{
 				auto equalsIndex = arg.find('=');
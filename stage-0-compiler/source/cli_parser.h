@@ -11,6 +11,8 @@ namespace cliParser
 		std::vector<std::string> flag_options{};
 		std::vector<std::pair<std::string, std::string>> value_options{};
 		std::vector<std::string> values{};
+		// everything after --run, which is passed on to the program being run
+		std::vector<std::string> run_arguments{};
 
 		bool valid{false};
 		std::string parse_error{};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -112,6 +113,7 @@ namespace json
 
 		JsonValue(const std::string& str) : JsonValue{JsonString{str}} {}
 		JsonValue(const char* str) : JsonValue{JsonString{str}} {}
+		JsonValue(std::string_view str) : JsonValue{JsonString{std::string{str}}} {}
 		JsonValue(bool bool_value) : JsonValue{}
 		{
 			if (bool_value)
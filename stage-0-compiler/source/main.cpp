@@ -1,4 +1,5 @@
 
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -8,9 +9,19 @@ int main(int argc, char** argv)
 {
 	cli::CLI cli(argc, argv);
 
-	if (cli.run())
+	bool success = cli.run();
+
+	if (cli.should_skip_teardown())
+	{
+		// all of the output files have been closed, so let the os free everything
+		std::cout.flush();
+		std::_Exit(success ? cli.get_exit_code() : 1);
+	}
+
+	if (success)
 	{
-		return 0;
+		// 0, unless the program was run and returned something else
+		return cli.get_exit_code();
 	}
 	else
 	{